@@ -0,0 +1,259 @@
+/*
+ * ASSET PACK - Single-file asset archive
+ * ASSET PACK - Archivio risorse in un singolo file
+ *
+ * All assets live in one archive built by asset_packer. On desktop the
+ * archive is memory-mapped and entries can be handed to SDL through
+ * SDL_RWFromConstMem without copying. On the web it is read once from the
+ * preloaded file system into the heap: preloaded files live outside the
+ * WebAssembly memory, so one copy is unavoidable, and after it entries are
+ * zero-copy as on desktop. Compressed entries (optional, see the Makefile)
+ * are expanded into a heap copy on first use.
+ *
+ * Tutte le risorse stanno in un archivio creato da asset_packer. Su desktop
+ * l'archivio è mappato in memoria e le voci passano a SDL tramite
+ * SDL_RWFromConstMem senza copie. Sul web viene copiato una volta nell'heap
+ * (i file precaricati stanno fuori dalla memoria WebAssembly), poi le voci
+ * sono senza copie. Le voci compresse (opzionali) vengono espanse al primo uso.
+ *
+ * File layout / Struttura file (little-endian):
+ *     [PackHeader][PackEntry * entry_count, sorted by name][data, each entry ALIGNMENT-aligned]
+ */
+
+#ifndef TETRIS_ASSET_PACK_H
+#define TETRIS_ASSET_PACK_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifndef __EMSCRIPTEN__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace assetpack {
+
+constexpr char MAGIC[4] = {'T', 'P', 'A', 'K'};
+constexpr uint32_t VERSION = 1;
+constexpr uint32_t ALIGNMENT = 64;        // Entry data alignment / Allineamento dati
+constexpr size_t NAME_SIZE = 48;          // Including terminator / Terminatore incluso
+constexpr uint32_t FLAG_COMPRESSED = 1;   // Stored with lz::compress / Salvata con lz::compress
+
+struct PackHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t entry_count;
+    uint32_t alignment;
+};
+static_assert(sizeof(PackHeader) == 16, "PackHeader layout is part of the file format");
+
+struct PackEntry {
+    char name[NAME_SIZE];  // Asset path, e.g. "audio/font.ttf" / Percorso, es. "audio/font.ttf"
+    uint64_t offset;       // From the start of the file / Dall'inizio del file
+    uint64_t size;         // Uncompressed bytes / Byte non compressi
+    uint64_t stored_size;  // Bytes in the file / Byte nel file
+    uint32_t flags;
+    uint32_t reserved;
+};
+static_assert(sizeof(PackEntry) == 80, "PackEntry layout is part of the file format");
+
+/*
+ * Minimal LZ77 block format / Formato LZ77 minimale:
+ * sequences of [token][literal length ext][literals][offset u16][match length ext];
+ * token = literal length (high nibble) | match length - 4 (low nibble), 15 = extended
+ * with 255-continued bytes. The last sequence carries literals only.
+ */
+namespace lz {
+
+inline bool readLength(const uint8_t*& src, const uint8_t* end, size_t& length) {
+    if (length != 15) return true;
+    uint8_t b;
+    do {
+        if (src >= end) return false;
+        b = *src++;
+        length += b;
+    } while (b == 255);
+    return true;
+}
+
+inline bool decompress(const uint8_t* src, size_t src_size, uint8_t* dst, size_t dst_size) {
+    const uint8_t* src_end = src + src_size;
+    uint8_t* out = dst;
+    uint8_t* out_end = dst + dst_size;
+
+    while (src < src_end) {
+        uint8_t token = *src++;
+        size_t literals = token >> 4;
+        if (!readLength(src, src_end, literals)) return false;
+        if (literals > static_cast<size_t>(src_end - src) || literals > static_cast<size_t>(out_end - out)) return false;
+        std::memcpy(out, src, literals);
+        src += literals;
+        out += literals;
+        if (src == src_end) break;  // Final literal-only sequence / Sequenza finale di soli letterali
+
+        if (src_end - src < 2) return false;
+        size_t offset = src[0] | (src[1] << 8);
+        src += 2;
+        size_t match = token & 15;
+        if (!readLength(src, src_end, match)) return false;
+        match += 4;
+        if (offset == 0 || offset > static_cast<size_t>(out - dst) || match > static_cast<size_t>(out_end - out)) {
+            return false;
+        }
+        // Byte by byte: matches may overlap their own output / Byte per byte: i match possono sovrapporsi
+        const uint8_t* from = out - offset;
+        for (size_t i = 0; i < match; ++i) out[i] = from[i];
+        out += match;
+    }
+    return out == out_end;
+}
+
+} // namespace lz
+
+// A read-only view of one asset / Vista in sola lettura di una risorsa
+struct AssetView {
+    const void* data;
+    size_t size;
+};
+
+class AssetPack {
+public:
+    AssetPack() : base(nullptr), file_size(0), entries(nullptr), count(0) {}
+
+    ~AssetPack() {
+        close();
+    }
+
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+
+    // Map (desktop) or load (web) an archive / Mappa (desktop) o carica (web) un archivio
+    bool open(const char* path) {
+        close();
+#ifndef __EMSCRIPTEN__
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(PackHeader))) {
+            ::close(fd);
+            return false;
+        }
+        void* mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);  // The mapping stays valid / La mappatura resta valida
+        if (mapped == MAP_FAILED) return false;
+        base = static_cast<const uint8_t*>(mapped);
+        file_size = static_cast<size_t>(st.st_size);
+#else
+        // Preloaded files already live in memory: read once / I file precaricati sono già in memoria
+        FILE* f = std::fopen(path, "rb");
+        if (!f) return false;
+        std::fseek(f, 0, SEEK_END);
+        long size = std::ftell(f);
+        std::fseek(f, 0, SEEK_SET);
+        if (size > 0) {
+            loaded.resize(static_cast<size_t>(size));
+            if (std::fread(loaded.data(), 1, loaded.size(), f) != loaded.size()) loaded.clear();
+        }
+        std::fclose(f);
+        if (loaded.size() < sizeof(PackHeader)) {
+            loaded.clear();
+            return false;
+        }
+        base = loaded.data();
+        file_size = loaded.size();
+#endif
+        if (!validate()) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+#ifndef __EMSCRIPTEN__
+        if (base) munmap(const_cast<uint8_t*>(base), file_size);
+#else
+        loaded.clear();
+        loaded.shrink_to_fit();
+#endif
+        base = nullptr;
+        file_size = 0;
+        entries = nullptr;
+        count = 0;
+        expanded.clear();
+    }
+
+    bool isOpen() const {
+        return base != nullptr;
+    }
+
+    // Find an asset by path; expands compressed entries once
+    // Cerca una risorsa per percorso; espande una sola volta le voci compresse
+    bool find(const char* name, AssetView& view) {
+        const PackEntry* end = entries + count;
+        const PackEntry* e = std::lower_bound(entries, end, name, [](const PackEntry& entry, const char* key) {
+            return std::strncmp(entry.name, key, NAME_SIZE) < 0;
+        });
+        if (e == end || std::strncmp(e->name, name, NAME_SIZE) != 0) return false;
+
+        if (!(e->flags & FLAG_COMPRESSED)) {
+            view.data = base + e->offset;
+            view.size = static_cast<size_t>(e->size);
+            return true;
+        }
+
+        std::unique_ptr<uint8_t[]>& buffer = expanded[e - entries];
+        if (!buffer) {
+            std::unique_ptr<uint8_t[]> out(new uint8_t[e->size ? e->size : 1]);
+            if (!lz::decompress(base + e->offset, static_cast<size_t>(e->stored_size), out.get(),
+                                static_cast<size_t>(e->size))) {
+                return false;
+            }
+            buffer = std::move(out);
+        }
+        view.data = buffer.get();
+        view.size = static_cast<size_t>(e->size);
+        return true;
+    }
+
+private:
+    const uint8_t* base;
+    size_t file_size;
+    const PackEntry* entries;
+    uint32_t count;
+    std::vector<std::unique_ptr<uint8_t[]>> expanded;  // Per entry, compressed only / Per voce, solo compresse
+#ifdef __EMSCRIPTEN__
+    std::vector<uint8_t> loaded;
+#endif
+
+    // Check the header and that every entry lies inside the file
+    // Controlla l'header e che ogni voce stia dentro il file
+    bool validate() {
+        PackHeader header;
+        std::memcpy(&header, base, sizeof(header));
+        if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION) return false;
+        if (header.entry_count > (file_size - sizeof(PackHeader)) / sizeof(PackEntry)) return false;
+
+        entries = reinterpret_cast<const PackEntry*>(base + sizeof(PackHeader));
+        count = header.entry_count;
+        for (uint32_t i = 0; i < count; ++i) {
+            const PackEntry& e = entries[i];
+            if (e.name[NAME_SIZE - 1] != '\0') return false;
+            if (e.offset > file_size || e.stored_size > file_size - e.offset) return false;
+            if (!(e.flags & FLAG_COMPRESSED) && e.stored_size != e.size) return false;
+        }
+        expanded.resize(count);
+        return true;
+    }
+};
+
+} // namespace assetpack
+
+#endif // TETRIS_ASSET_PACK_H
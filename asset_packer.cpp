@@ -0,0 +1,192 @@
+/*
+ * ASSET PACKER - Builds the asset archive read by asset_pack.h
+ * ASSET PACKER - Crea l'archivio risorse letto da asset_pack.h
+ *
+ * Usage / Uso:
+ *     asset_packer [--no-compress] output.pak name=path [name=path ...]
+ *
+ * Each entry is compressed only when it saves at least 10%; already
+ * compressed formats (OGG, TTF hinting tables) are usually stored as is.
+ * Ogni voce viene compressa solo se risparmia almeno il 10%.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "asset_pack.h"
+
+using namespace assetpack;
+
+// Greedy LZ77 matching the lz::decompress format / LZ77 greedy compatibile con lz::decompress
+static void writeLength(std::vector<uint8_t>& out, size_t length) {
+    while (length >= 255) {
+        out.push_back(255);
+        length -= 255;
+    }
+    out.push_back(static_cast<uint8_t>(length));
+}
+
+static void emitSequence(std::vector<uint8_t>& out, const uint8_t* literals, size_t literal_count,
+                         size_t offset, size_t match) {
+    size_t lit_code = std::min<size_t>(literal_count, 15);
+    size_t match_code = match ? std::min<size_t>(match - 4, 15) : 0;
+    out.push_back(static_cast<uint8_t>((lit_code << 4) | match_code));
+    if (lit_code == 15) writeLength(out, literal_count - 15);
+    out.insert(out.end(), literals, literals + literal_count);
+    if (!match) return;  // Final sequence / Sequenza finale
+    out.push_back(static_cast<uint8_t>(offset & 0xff));
+    out.push_back(static_cast<uint8_t>(offset >> 8));
+    if (match_code == 15) writeLength(out, match - 4 - 15);
+}
+
+static std::vector<uint8_t> compress(const std::vector<uint8_t>& in) {
+    const size_t HASH_BITS = 16;
+    const size_t MAX_OFFSET = 65535;
+    std::vector<int64_t> table(size_t(1) << HASH_BITS, -1);
+    std::vector<uint8_t> out;
+    out.reserve(in.size() / 2);
+
+    size_t anchor = 0;
+    size_t i = 0;
+    while (i + 4 <= in.size()) {
+        uint32_t word;
+        std::memcpy(&word, &in[i], 4);
+        size_t h = (word * 2654435761u) >> (32 - HASH_BITS);
+        int64_t candidate = table[h];
+        table[h] = static_cast<int64_t>(i);
+
+        if (candidate >= 0 && i - candidate <= MAX_OFFSET && std::memcmp(&in[candidate], &in[i], 4) == 0) {
+            size_t match = 4;
+            while (i + match < in.size() && in[candidate + match] == in[i + match]) match++;
+            emitSequence(out, &in[anchor], i - anchor, i - candidate, match);
+            i += match;
+            anchor = i;
+        } else {
+            i++;
+        }
+    }
+    emitSequence(out, in.data() + anchor, in.size() - anchor, 0, 0);
+    return out;
+}
+
+static bool readFile(const char* path, std::vector<uint8_t>& data) {
+    FILE* f = std::fopen(path, "rb");
+    if (!f) return false;
+    std::fseek(f, 0, SEEK_END);
+    long size = std::ftell(f);
+    std::fseek(f, 0, SEEK_SET);
+    data.resize(size > 0 ? static_cast<size_t>(size) : 0);
+    bool ok = data.empty() || std::fread(data.data(), 1, data.size(), f) == data.size();
+    std::fclose(f);
+    return ok;
+}
+
+struct InputEntry {
+    std::string name;
+    std::vector<uint8_t> stored;
+    uint64_t size;
+    uint32_t flags;
+};
+
+int main(int argc, char* argv[]) {
+    bool allow_compression = true;
+    int arg = 1;
+    if (arg < argc && std::strcmp(argv[arg], "--no-compress") == 0) {
+        allow_compression = false;
+        arg++;
+    }
+    if (argc - arg < 2) {
+        std::fprintf(stderr, "Usage: %s [--no-compress] output.pak name=path [name=path ...]\n", argv[0]);
+        return 2;
+    }
+    const char* output = argv[arg++];
+
+    std::vector<InputEntry> inputs;
+    for (; arg < argc; ++arg) {
+        const char* eq = std::strchr(argv[arg], '=');
+        if (!eq || eq == argv[arg] || static_cast<size_t>(eq - argv[arg]) >= NAME_SIZE) {
+            std::fprintf(stderr, "Invalid entry (expected name=path, name < %zu chars): %s\n", NAME_SIZE, argv[arg]);
+            return 2;
+        }
+        InputEntry entry;
+        entry.name.assign(argv[arg], static_cast<size_t>(eq - argv[arg]));
+        std::vector<uint8_t> data;
+        if (!readFile(eq + 1, data)) {
+            std::fprintf(stderr, "Cannot read %s\n", eq + 1);
+            return 1;
+        }
+        entry.size = data.size();
+        entry.flags = 0;
+        if (allow_compression && !data.empty()) {
+            std::vector<uint8_t> packed = compress(data);
+            if (packed.size() * 10 <= data.size() * 9) {
+                entry.stored.swap(packed);
+                entry.flags = FLAG_COMPRESSED;
+            }
+        }
+        if (!entry.flags) entry.stored.swap(data);
+        inputs.push_back(std::move(entry));
+    }
+
+    // The reader binary-searches the index / Il lettore usa la ricerca binaria sull'indice
+    std::sort(inputs.begin(), inputs.end(),
+              [](const InputEntry& a, const InputEntry& b) { return a.name < b.name; });
+    for (size_t i = 1; i < inputs.size(); ++i) {
+        if (inputs[i].name == inputs[i - 1].name) {
+            std::fprintf(stderr, "Duplicate entry: %s\n", inputs[i].name.c_str());
+            return 2;
+        }
+    }
+
+    PackHeader header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.entry_count = static_cast<uint32_t>(inputs.size());
+    header.alignment = ALIGNMENT;
+
+    std::vector<PackEntry> index(inputs.size());
+    uint64_t offset = sizeof(PackHeader) + inputs.size() * sizeof(PackEntry);
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        offset = (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+        PackEntry& e = index[i];
+        std::memset(&e, 0, sizeof(e));
+        std::strncpy(e.name, inputs[i].name.c_str(), NAME_SIZE - 1);
+        e.offset = offset;
+        e.size = inputs[i].size;
+        e.stored_size = inputs[i].stored.size();
+        e.flags = inputs[i].flags;
+        offset += e.stored_size;
+    }
+
+    FILE* out = std::fopen(output, "wb");
+    if (!out) {
+        std::fprintf(stderr, "Cannot write %s\n", output);
+        return 1;
+    }
+    bool ok = std::fwrite(&header, sizeof(header), 1, out) == 1;
+    ok = ok && (index.empty() || std::fwrite(index.data(), sizeof(PackEntry), index.size(), out) == index.size());
+    uint64_t written = sizeof(PackHeader) + index.size() * sizeof(PackEntry);
+    static const uint8_t zeros[ALIGNMENT] = {};
+    for (size_t i = 0; ok && i < inputs.size(); ++i) {
+        size_t padding = static_cast<size_t>(index[i].offset - written);
+        ok = std::fwrite(zeros, 1, padding, out) == padding;
+        ok = ok && (inputs[i].stored.empty() ||
+                    std::fwrite(inputs[i].stored.data(), 1, inputs[i].stored.size(), out) == inputs[i].stored.size());
+        written = index[i].offset + index[i].stored_size;
+        std::printf("%-24s %10llu -> %10llu%s\n", inputs[i].name.c_str(),
+                    static_cast<unsigned long long>(index[i].size),
+                    static_cast<unsigned long long>(index[i].stored_size),
+                    (index[i].flags & FLAG_COMPRESSED) ? " (lz)" : "");
+    }
+    ok = (std::fclose(out) == 0) && ok;
+    if (!ok) {
+        std::fprintf(stderr, "Write error on %s\n", output);
+        std::remove(output);
+        return 1;
+    }
+    std::printf("%s: %zu entries, %llu bytes\n", output, inputs.size(), static_cast<unsigned long long>(written));
+    return 0;
+}
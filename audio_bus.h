@@ -0,0 +1,144 @@
+/*
+ * AUDIO BUS - Lock-free volume and mute control
+ * BUS AUDIO - Controllo lock-free di volume e mute
+ *
+ * The main thread only stores volume/mute targets in atomics. A SDL_mixer
+ * post-mix callback, running on the audio thread, applies the master gain
+ * to the final mix and ramps it towards the target sample by sample, so
+ * slider drags cause no mixer API calls and no zipper noise.
+ * Music and channel volumes stay at MIX_MAX_VOLUME while the bus is active.
+ *
+ * Il thread principale scrive solo i valori obiettivo in variabili atomiche.
+ * Una callback post-mix di SDL_mixer, sul thread audio, applica il guadagno
+ * al mix finale con una rampa graduale, senza chiamate al mixer dalla UI.
+ *
+ * The callback also accumulates its own run time for profiling.
+ * La callback accumula anche il proprio tempo di esecuzione per il profiling.
+ */
+
+#ifndef TETRIS_AUDIO_BUS_H
+#define TETRIS_AUDIO_BUS_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_mixer.h>
+#include <atomic>
+#include <cstdint>
+
+class AudioBus {
+public:
+    static constexpr int RAMP_MS = 30;  // Time for a full 0 -> max sweep / Tempo per una rampa completa
+
+    AudioBus()
+        : target_volume(MIX_MAX_VOLUME), muted(false), active(false),
+          callback_count(0), callback_ticks(0), callback_max_ticks(0),
+          gain(1.0f), gain_step(0.0f), channels(2) {}
+
+    // Hook into the mixer; false if the output format is not supported
+    // Si aggancia al mixer; false se il formato di uscita non è supportato
+    bool install() {
+        int frequency = 0, output_channels = 0;
+        Uint16 format = 0;
+        if (!Mix_QuerySpec(&frequency, &format, &output_channels) || format != AUDIO_S16SYS) {
+            return false;
+        }
+        channels = output_channels;
+        gain_step = 1.0f / (frequency * RAMP_MS / 1000.0f);
+        gain = targetGain();
+
+        // The bus owns the gain from now on / Da qui il guadagno è gestito dal bus
+        Mix_VolumeMusic(MIX_MAX_VOLUME);
+        Mix_Volume(-1, MIX_MAX_VOLUME);
+        Mix_SetPostMix(postMix, this);
+        active.store(true);
+        return true;
+    }
+
+    void uninstall() {
+        if (active.exchange(false)) {
+            Mix_SetPostMix(nullptr, nullptr);
+        }
+    }
+
+    bool isActive() const {
+        return active.load(std::memory_order_relaxed);
+    }
+
+    // Main thread: just publish the new targets / Thread principale: pubblica solo gli obiettivi
+    void setVolume(int volume) {
+        target_volume.store(volume, std::memory_order_relaxed);
+    }
+
+    void setMuted(bool mute) {
+        muted.store(mute, std::memory_order_relaxed);
+    }
+
+    // Callback profiling / Profiling della callback
+    uint64_t callbackCount() const { return callback_count.load(std::memory_order_relaxed); }
+
+    uint64_t callbackMicros() const {
+        return callback_ticks.load(std::memory_order_relaxed) * 1000000 / SDL_GetPerformanceFrequency();
+    }
+
+    uint64_t callbackMaxMicros() const {
+        return callback_max_ticks.load(std::memory_order_relaxed) * 1000000 / SDL_GetPerformanceFrequency();
+    }
+
+private:
+    std::atomic<int> target_volume;  // 0-128
+    std::atomic<bool> muted;
+    std::atomic<bool> active;
+    std::atomic<uint64_t> callback_count;
+    std::atomic<uint64_t> callback_ticks;
+    std::atomic<uint64_t> callback_max_ticks;
+
+    // Audio thread only / Solo thread audio
+    float gain;
+    float gain_step;  // Per sample frame / Per frame di campioni
+    int channels;
+
+    float targetGain() const {
+        if (muted.load(std::memory_order_relaxed)) return 0.0f;
+        return static_cast<float>(target_volume.load(std::memory_order_relaxed)) / MIX_MAX_VOLUME;
+    }
+
+    static void SDLCALL postMix(void* udata, Uint8* stream, int len) {
+        AudioBus* bus = static_cast<AudioBus*>(udata);
+        Uint64 start = SDL_GetPerformanceCounter();
+
+        Sint16* samples = reinterpret_cast<Sint16*>(stream);
+        int frames = len / (static_cast<int>(sizeof(Sint16)) * bus->channels);
+        float target = bus->targetGain();
+        float g = bus->gain;
+
+        if (g == target) {
+            // Steady state: unity gain needs no work / Stato stabile: guadagno unitario senza lavoro
+            if (g != 1.0f) {
+                for (int i = 0; i < frames * bus->channels; ++i) {
+                    samples[i] = static_cast<Sint16>(samples[i] * g);
+                }
+            }
+        } else {
+            for (int f = 0; f < frames; ++f) {
+                if (g < target) {
+                    g = g + bus->gain_step < target ? g + bus->gain_step : target;
+                } else if (g > target) {
+                    g = g - bus->gain_step > target ? g - bus->gain_step : target;
+                }
+                for (int c = 0; c < bus->channels; ++c) {
+                    Sint16& s = samples[f * bus->channels + c];
+                    s = static_cast<Sint16>(s * g);
+                }
+            }
+            bus->gain = g;
+        }
+
+        Uint64 elapsed = SDL_GetPerformanceCounter() - start;
+        bus->callback_count.fetch_add(1, std::memory_order_relaxed);
+        bus->callback_ticks.fetch_add(elapsed, std::memory_order_relaxed);
+        if (elapsed > bus->callback_max_ticks.load(std::memory_order_relaxed)) {
+            bus->callback_max_ticks.store(elapsed, std::memory_order_relaxed);
+        }
+    }
+};
+
+#endif // TETRIS_AUDIO_BUS_H
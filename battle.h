@@ -0,0 +1,396 @@
+/*
+ * BATTLE VIEW - Miniature opponent boards next to the main board
+ * VISTA BATTAGLIA - Griglie avversarie in miniatura accanto alla griglia principale
+ *
+ * Every opponent board owns one slot of a single streaming texture (the
+ * atlas). A slot is redrawn on the CPU and uploaded only when its board
+ * changes: a piece locks, lines clear, the board tops out or restarts.
+ * Falling pieces are not shown. The whole panel is then drawn with one
+ * SDL_RenderCopy, so the cost per frame does not grow with the number of
+ * boards the way one SDL_RenderFillRect per block would.
+ *
+ * Ogni griglia avversaria ha uno slot in un'unica texture streaming
+ * (l'atlante), ridisegnato e caricato solo quando la griglia cambia.
+ * Il pannello intero si disegna con un solo SDL_RenderCopy.
+ *
+ * Opponents are local bots that hard-drop each piece where a simple
+ * height/holes heuristic likes it best, using Perft's collision and lock
+ * rules (the same as the game). Only placements with all four cells inside
+ * the grid count. After topping out a board stays dimmed for a few
+ * seconds, then starts over.
+ * Gli avversari sono bot locali che usano le regole di Perft.
+ */
+
+#ifndef TETRIS_BATTLE_H
+#define TETRIS_BATTLE_H
+
+#include <SDL2/SDL.h>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "perft.h"
+
+namespace battle {
+
+constexpr int MAX_BOARDS = 100;
+constexpr int COLUMNS = 10;        // Boards per atlas row / Griglie per riga dell'atlante
+constexpr int MINI_CELL = 3;       // Pixels per cell / Pixel per cella
+constexpr int GAP = 2;             // Pixels between boards / Pixel tra le griglie
+constexpr int SLOT_WIDTH = Perft::WIDTH * MINI_CELL + GAP;
+constexpr int SLOT_HEIGHT = Perft::HEIGHT * MINI_CELL + GAP;
+constexpr int MARGIN = 8;
+constexpr int PANEL_WIDTH = COLUMNS * SLOT_WIDTH + 2 * MARGIN;  // Extra window width / Larghezza aggiuntiva della finestra
+constexpr Uint32 RESTART_DELAY_MS = 3000;
+
+// Seed of bot `index`, shared by the view and the bench check / Seme del bot `index`, comune a vista e benchmark
+inline uint32_t botSeed(uint32_t seed, int index) {
+    return seed * 2654435761u + static_cast<uint32_t>(index) * 40503u + 1;
+}
+
+// One bot-played board / Una griglia giocata da un bot
+class Opponent {
+public:
+    Opponent()
+        : rng(1), interval_ms(500), next_lock_ms(0), over_since_ms(0), game_over(false), noise(0),
+          pieces(0), top_outs(0) {}
+
+    void reset(uint32_t seed, Uint32 now) {
+        board = Perft::Board();
+        for (auto& row : cells) {
+            for (uint8_t& cell : row) cell = 0;
+        }
+        game_over = false;
+        rng = seed ? seed : 1;
+        // Pace and sloppiness vary per bot / Ritmo e imprecisione variano per bot
+        interval_ms = 250 + next() % 600;
+        noise = static_cast<int>(next() % 600);
+        next_lock_ms = now + interval_ms;
+    }
+
+    // Play up to `now`; true when the board changed / Gioca fino a `now`; true se la griglia è cambiata
+    bool update(const Perft& rules, const Perft::ShapeTable& shapes, Uint32 now) {
+        if (game_over) {
+            if (now - over_since_ms < RESTART_DELAY_MS) return false;
+            reset(rng, now);
+            return true;
+        }
+        bool changed = false;
+        // Catch up after a stall, but not forever / Recupera dopo uno stallo, ma non all'infinito
+        for (int step = 0; step < 4 && static_cast<int32_t>(now - next_lock_ms) >= 0; ++step) {
+            changed |= placeNext(rules, shapes);
+            next_lock_ms += interval_ms;
+            if (game_over) {
+                over_since_ms = now;
+                top_outs++;
+                return true;
+            }
+        }
+        if (static_cast<int32_t>(now - next_lock_ms) >= 0) next_lock_ms = now + interval_ms;
+        return changed;
+    }
+
+    uint8_t cell(int x, int y) const {
+        return cells[y][x];  // 0 = empty, else type + 1 / 0 = vuota, altrimenti tipo + 1
+    }
+
+    bool isOver() const {
+        return game_over;
+    }
+
+    // Totals across restarts / Totali tra un riavvio e l'altro
+    uint64_t pieceCount() const {
+        return pieces;
+    }
+
+    uint64_t topOutCount() const {
+        return top_outs;
+    }
+
+private:
+    Perft::Board board;                            // Occupancy for the rules / Occupazione per le regole
+    uint8_t cells[Perft::HEIGHT][Perft::WIDTH] = {};  // Colors for drawing / Colori per il disegno
+    uint32_t rng;
+    Uint32 interval_ms;
+    Uint32 next_lock_ms;
+    Uint32 over_since_ms;
+    bool game_over;
+    int noise;
+    uint64_t pieces;
+    uint64_t top_outs;
+
+    uint32_t next() {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        return rng;
+    }
+
+    static int filledCells(const Perft::Board& b) {
+        int n = 0;
+        for (uint16_t row : b.rows) n += __builtin_popcount(row);
+        return n;
+    }
+
+    // Higher is better: lines up, aggregate height, holes and bumpiness down
+    // Più alto è meglio: premia le linee, penalizza altezza, buchi e irregolarità
+    static int evaluate(const Perft::Board& b, int lines) {
+        int heights[Perft::WIDTH];
+        int holes = 0;
+        for (int x = 0; x < Perft::WIDTH; ++x) {
+            heights[x] = 0;
+            for (int y = 0; y < Perft::HEIGHT; ++y) {
+                bool filled = (b.rows[y] >> x) & 1;
+                if (filled && !heights[x]) heights[x] = Perft::HEIGHT - y;
+                else if (!filled && heights[x]) holes++;
+            }
+        }
+        int aggregate = 0, bumpiness = 0;
+        for (int x = 0; x < Perft::WIDTH; ++x) {
+            aggregate += heights[x];
+            if (x > 0) bumpiness += std::abs(heights[x] - heights[x - 1]);
+        }
+        return lines * 76 - aggregate * 51 - holes * 36 - bumpiness * 18;
+    }
+
+    // All 4 cells inside the grid; pieces resting above it never touch a wall or a block
+    // Tutte e 4 le celle dentro la griglia; i pezzi fermi sopra non toccano né muri né blocchi
+    static bool landsInside(const Perft::ShapeTable& shapes, int type, int x, int y, int rot) {
+        for (int i = 0; i < 16; ++i) {
+            if (!shapes[type][rot][i]) continue;
+            int gx = x + i % 4;
+            int gy = y + i / 4;
+            if (gx < 0 || gx >= Perft::WIDTH || gy < 0 || gy >= Perft::HEIGHT) return false;
+        }
+        return true;
+    }
+
+    // Hard-drop a random piece at the best column and rotation; true if the board changed
+    // Fa cadere un pezzo casuale nel punto migliore; true se la griglia è cambiata
+    bool placeNext(const Perft& rules, const Perft::ShapeTable& shapes) {
+        int type = static_cast<int>(next() % 7);
+        int best_score = 0, best_x = 0, best_y = 0, best_rot = -1;
+        Perft::Board best;
+        int before = filledCells(board);
+
+        for (int rot = 0; rot < 4; ++rot) {
+            for (int x = -3; x < Perft::WIDTH; ++x) {
+                if (rules.collides(board, type, x, Perft::SPAWN_Y, rot)) continue;
+                int y = Perft::SPAWN_Y;
+                while (!rules.collides(board, type, x, y + 1, rot)) y++;
+                if (!landsInside(shapes, type, x, y, rot)) continue;
+                Perft::Board child = rules.lock(board, type, x, y, rot);
+                int lines = (before + 4 - filledCells(child)) / Perft::WIDTH;
+                int score = evaluate(child, lines) * 10 - (child.game_over ? 100000 : 0) +
+                            (noise ? static_cast<int>(next() % (noise + 1)) : 0);
+                if (best_rot < 0 || score > best_score) {
+                    best_score = score;
+                    best_x = x;
+                    best_y = y;
+                    best_rot = rot;
+                    best = child;
+                }
+            }
+        }
+        if (best_rot < 0) {
+            game_over = true;  // No room left: topped out / Nessuno spazio: partita finita
+            return true;       // Dimmed from now on / Da ora attenuata
+        }
+
+        // Mirror placePiece + clearLines on the color grid / Ripete placePiece + clearLines sui colori
+        for (int i = 0; i < 16; ++i) {
+            int gx = best_x + i % 4;
+            int gy = best_y + i / 4;
+            if (shapes[type][best_rot][i] && gy >= 0 && gy < Perft::HEIGHT && gx >= 0 && gx < Perft::WIDTH) {
+                cells[gy][gx] = static_cast<uint8_t>(type + 1);
+            }
+        }
+        int dst = Perft::HEIGHT - 1;
+        for (int src = Perft::HEIGHT - 1; src >= 0; --src) {
+            bool full = true;
+            for (int x = 0; x < Perft::WIDTH && full; ++x) full = cells[src][x] != 0;
+            if (full) continue;
+            if (dst != src) {
+                for (int x = 0; x < Perft::WIDTH; ++x) cells[dst][x] = cells[src][x];
+            }
+            dst--;
+        }
+        for (; dst >= 0; --dst) {
+            for (int x = 0; x < Perft::WIDTH; ++x) cells[dst][x] = 0;
+        }
+        board = best;
+        game_over = board.game_over;
+        pieces++;
+        return true;
+    }
+};
+
+class BattleView {
+public:
+    // `colors` are 0xRRGGBB per tetromino type / `colors` sono 0xRRGGBB per tipo di tetromino
+    BattleView(const Perft::ShapeTable& shapes, const uint32_t colors[7])
+        : shapes(shapes), rules(shapes, std::vector<int>(1, 0), 0, 1), atlas(nullptr),
+          atlas_rows(0), per_block(false), uploads(0) {
+        for (int t = 0; t < 7; ++t) palette[t] = colors[t];
+    }
+
+    ~BattleView() {
+        destroy();
+    }
+
+    // Create the atlas for `count` boards / Crea l'atlante per `count` griglie
+    bool create(SDL_Renderer* renderer, int count, uint32_t seed, Uint32 now) {
+        destroy();
+        if (count < 1) count = 1;
+        if (count > MAX_BOARDS) count = MAX_BOARDS;
+        atlas_rows = (count + COLUMNS - 1) / COLUMNS;
+        // RGB888 has no alpha: the software renderer copies it row by row
+        // RGB888 non ha alfa: il renderer software lo copia riga per riga
+        atlas = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGB888, SDL_TEXTUREACCESS_STREAMING,
+                                  COLUMNS * SLOT_WIDTH, atlas_rows * SLOT_HEIGHT);
+        if (!atlas) return false;
+        SDL_SetTextureBlendMode(atlas, SDL_BLENDMODE_NONE);
+
+        // Background for the gaps and unused slots / Sfondo per spazi e slot inutilizzati
+        void* pixels;
+        int pitch;
+        if (SDL_LockTexture(atlas, nullptr, &pixels, &pitch) != 0) {
+            destroy();
+            return false;
+        }
+        for (int y = 0; y < atlas_rows * SLOT_HEIGHT; ++y) {
+            uint32_t* row = reinterpret_cast<uint32_t*>(static_cast<uint8_t*>(pixels) + y * pitch);
+            for (int x = 0; x < COLUMNS * SLOT_WIDTH; ++x) row[x] = BACKGROUND;
+        }
+        SDL_UnlockTexture(atlas);
+
+        opponents.assign(count, Opponent());
+        dirty.assign(count, true);
+        for (int i = 0; i < count; ++i) {
+            opponents[i].reset(botSeed(seed, i), now);
+        }
+        return true;
+    }
+
+    void destroy() {
+        if (atlas) {
+            SDL_DestroyTexture(atlas);
+            atlas = nullptr;
+        }
+        opponents.clear();
+        dirty.clear();
+    }
+
+    // Advance the bots and upload the boards that changed / Fa avanzare i bot e carica le griglie cambiate
+    void update(Uint32 now) {
+        for (size_t i = 0; i < opponents.size(); ++i) {
+            if (opponents[i].update(rules, shapes, now)) dirty[i] = true;
+        }
+        if (per_block) return;
+        for (size_t i = 0; i < opponents.size(); ++i) {
+            if (dirty[i]) {
+                upload(static_cast<int>(i));
+                dirty[i] = false;
+            }
+        }
+    }
+
+    // Draw the panel at (x, y); returns the render calls issued / Disegna il pannello; restituisce le chiamate di rendering
+    Uint32 draw(SDL_Renderer* renderer, int x, int y) const {
+        if (!atlas) return 0;
+        if (per_block) return drawPerBlock(renderer, x, y);
+        SDL_Rect area = {0, 0, COLUMNS * SLOT_WIDTH, atlas_rows * SLOT_HEIGHT};
+        SDL_Rect dst = {x, y, area.w, area.h};
+        SDL_RenderCopy(renderer, atlas, &area, &dst);
+        return 1;
+    }
+
+    // Benchmark reference: one fill per block instead of the atlas / Riferimento per il benchmark: un fill per blocco
+    void setPerBlock(bool enabled) {
+        per_block = enabled;
+        dirty.assign(opponents.size(), true);
+    }
+
+    int boardCount() const {
+        return static_cast<int>(opponents.size());
+    }
+
+    // Slots redrawn and uploaded so far / Slot ridisegnati e caricati finora
+    uint64_t uploadCount() const {
+        return uploads;
+    }
+
+    // Pieces locked and games lost by all bots / Pezzi bloccati e partite perse da tutti i bot
+    uint64_t pieceCount() const {
+        uint64_t n = 0;
+        for (const Opponent& o : opponents) n += o.pieceCount();
+        return n;
+    }
+
+    uint64_t topOutCount() const {
+        uint64_t n = 0;
+        for (const Opponent& o : opponents) n += o.topOutCount();
+        return n;
+    }
+
+private:
+    static constexpr uint32_t BACKGROUND = 0x1e1e1e;  // Window clear color / Colore di sfondo della finestra
+    static constexpr uint32_t EMPTY_CELL = 0x2a2a2a;
+
+    const Perft::ShapeTable& shapes;
+    Perft rules;
+    uint32_t palette[7];
+    SDL_Texture* atlas;
+    int atlas_rows;
+    bool per_block;
+    uint64_t uploads;
+    std::vector<Opponent> opponents;
+    std::vector<bool> dirty;
+
+    uint32_t cellColor(const Opponent& o, int x, int y) const {
+        uint8_t c = o.cell(x, y);
+        uint32_t rgb = c ? palette[c - 1] : EMPTY_CELL;
+        return o.isOver() ? (rgb >> 1) & 0x7f7f7f : rgb;  // Dimmed until restart / Attenuata fino al riavvio
+    }
+
+    // Redraw one slot straight into the texture / Ridisegna uno slot direttamente nella texture
+    void upload(int index) {
+        const Opponent& o = opponents[index];
+        SDL_Rect slot = {(index % COLUMNS) * SLOT_WIDTH, (index / COLUMNS) * SLOT_HEIGHT,
+                         Perft::WIDTH * MINI_CELL, Perft::HEIGHT * MINI_CELL};
+        void* pixels;
+        int pitch;
+        if (SDL_LockTexture(atlas, &slot, &pixels, &pitch) != 0) return;
+        for (int y = 0; y < slot.h; ++y) {
+            uint32_t* row = reinterpret_cast<uint32_t*>(static_cast<uint8_t*>(pixels) + y * pitch);
+            for (int cx = 0; cx < Perft::WIDTH; ++cx) {
+                uint32_t color = cellColor(o, cx, y / MINI_CELL);
+                for (int px = 0; px < MINI_CELL; ++px) *row++ = color;
+            }
+        }
+        SDL_UnlockTexture(atlas);
+        uploads++;
+    }
+
+    Uint32 drawPerBlock(SDL_Renderer* renderer, int x, int y) const {
+        Uint32 calls = 0;
+        for (size_t i = 0; i < opponents.size(); ++i) {
+            int ox = x + static_cast<int>(i % COLUMNS) * SLOT_WIDTH;
+            int oy = y + static_cast<int>(i / COLUMNS) * SLOT_HEIGHT;
+            for (int cy = 0; cy < Perft::HEIGHT; ++cy) {
+                for (int cx = 0; cx < Perft::WIDTH; ++cx) {
+                    uint32_t color = cellColor(opponents[i], cx, cy);
+                    SDL_Rect block = {ox + cx * MINI_CELL, oy + cy * MINI_CELL, MINI_CELL, MINI_CELL};
+                    SDL_SetRenderDrawColor(renderer, color >> 16, (color >> 8) & 0xff, color & 0xff, 255);
+                    SDL_RenderFillRect(renderer, &block);
+                    calls++;
+                }
+            }
+        }
+        return calls;
+    }
+};
+
+} // namespace battle
+
+#endif // TETRIS_BATTLE_H
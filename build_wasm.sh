@@ -35,20 +35,48 @@ fi
 # Crea cartella web se non esiste / Create web folder if it doesn't exist
 mkdir -p web
 
-# Copia asset nella cartella web / Copy assets to web folder
-echo "📁 Copiando asset audio nella cartella web..."
-echo "📁 Copying audio assets to web folder..."
-cp -r audio web/
+# Le risorse arrivano solo da tetris.pak: web/audio non serve più
+# Assets come only from tetris.pak: web/audio is no longer needed
+if [ ! -f audio/font.ttf ]; then
+    echo "⚠️  audio/font.ttf mancante - il gioco potrebbe non mostrare testo"
+    echo "⚠️  audio/font.ttf missing - game might not display text"
+fi
 
-# Copia font di sistema per il gioco / Copy system font for the game
-if [ -f "/usr/share/fonts/truetype/dejavu/DejaVuSans-Bold.ttf" ]; then
-    cp "/usr/share/fonts/truetype/dejavu/DejaVuSans-Bold.ttf" web/audio/font.ttf
-    echo "✅ Font copiato / Font copied"
-else
-    echo "⚠️  Font di sistema non trovato - il gioco potrebbe non mostrare testo"
-    echo "⚠️  System font not found - game might not display text"
+# Effetti sonori sintetizzati (SYNTH_SFX=1): i WAV restano fuori dall'archivio
+# Synthesized sound effects (SYNTH_SFX=1): the WAVs are left out of the archive
+SYNTH_FLAGS=""
+if [ "${SYNTH_SFX:-0}" = "1" ]; then
+    echo "🎹 Effetti sonori sintetizzati all'avvio"
+    echo "🎹 Sound effects synthesized at startup"
+    SYNTH_FLAGS="-DTETRIS_SYNTH_SFX"
+fi
+
+# Build leggera (LEAN=1): niente eccezioni né RTTI, allocatore minimale, memoria iniziale ridotta
+# Lean build (LEAN=1): no exceptions or RTTI, minimal allocator, smaller initial memory
+OPT_FLAGS="-O2"
+MEMORY_FLAGS="-s INITIAL_MEMORY=33554432"
+LEAN_FLAGS=""
+if [ "${LEAN:-0}" = "1" ]; then
+    echo "🪶 Build leggera"
+    echo "🪶 Lean build"
+    OPT_FLAGS="-Os"
+    # PROVVISORIO: 8 MB è una stima (archivio in memoria ~2.9 MB + suoni decodificati), non una misura.
+    # Il report qui sotto misura peak_heap e suggerisce il valore da mettere qui; la crescita resta attiva.
+    # PROVISIONAL: 8 MB is an estimate (in-memory archive ~2.9 MB + decoded sounds), not a measurement.
+    # The report below measures peak_heap and suggests the value to put here; growth stays enabled.
+    LEAN_INITIAL_MEMORY="${LEAN_INITIAL_MEMORY:-8388608}"
+    MEMORY_FLAGS="-s INITIAL_MEMORY=$LEAN_INITIAL_MEMORY"
+    LEAN_FLAGS="-fno-exceptions -fno-rtti -s MALLOC=emmalloc -s ENVIRONMENT=web"
 fi
 
+# Impacchetta tutte le risorse in tetris.pak (un solo file precaricato);
+# make lo ricostruisce quando cambiano le risorse o SYNTH_SFX
+# Pack every asset into tetris.pak (a single preloaded file);
+# make rebuilds it when the assets or SYNTH_SFX change
+echo "📦 Creando l'archivio risorse..."
+echo "📦 Building the asset archive..."
+make tetris.pak SYNTH_SFX="${SYNTH_SFX:-0}"
+
 # Compila tetris.cpp a WebAssembly / Compile tetris.cpp to WebAssembly
 echo "🔨 Compilando tetris_web.cpp a WebAssembly..."
 echo "🔨 Compiling tetris_web.cpp to WebAssembly..."
@@ -59,12 +87,15 @@ em++ tetris_web.cpp \
     -s USE_SDL_MIXER=2 \
     -s WASM=1 \
     -s ALLOW_MEMORY_GROWTH=1 \
-    -s INITIAL_MEMORY=33554432 \
-    -s EXPORTED_FUNCTIONS='["_main", "_startTetrisGame", "_restartTetrisGame", "_getScore", "_getLevel", "_getLines", "_isGameRunning", "_isGamePaused", "_setVolume", "_getVolume", "_muteAudio", "_toggleMute", "_isAudioMuted"]' \
+    $MEMORY_FLAGS \
+    -s EXPORTED_FUNCTIONS='["_main", "_startTetrisGame", "_restartTetrisGame", "_getScore", "_getLevel", "_getLines", "_getHighScore", "_isGameRunning", "_isGamePaused", "_setVolume", "_getVolume", "_muteAudio", "_toggleMute", "_isAudioMuted", "_getAudioCallbackCount", "_getAudioCallbackMicros", "_getPeakHeapBytes", "_getMemoryBytes"]' \
     -s EXPORTED_RUNTIME_METHODS='["ccall", "cwrap"]' \
-    --preload-file web/audio@audio \
+    $SYNTH_FLAGS \
+    $LEAN_FLAGS \
+    --preload-file tetris.pak@tetris.pak \
     --use-preload-plugins \
-    -O2 \
+    $OPT_FLAGS \
+    -DNDEBUG \
     -o web/tetris.html
 
 # Crea index.html che reindirizza al gioco / Create index.html that redirects to the game
@@ -120,6 +151,40 @@ EOF
 
 echo "✅ Compilazione completata!"
 echo "✅ Compilation completed!"
+
+# Report dimensioni (download) / Size report (download)
+echo ""
+echo "📊 Dimensioni / Sizes:"
+for f in web/tetris.wasm web/tetris.data web/tetris.js; do
+    if [ -f "$f" ]; then
+        printf "   %-14s %10d B   gzip %10d B\n" "$(basename "$f")" "$(wc -c < "$f")" "$(gzip -9 -c "$f" | wc -c)"
+    fi
+done
+
+# Heap di picco: esegue la build in Chrome headless (serve node + puppeteer)
+# Peak heap: runs the build in headless Chrome (needs node + puppeteer)
+PEAK_HEAP=""
+if command -v node > /dev/null 2>&1; then
+    MEASURED=$(NODE_PATH="${NODE_PATH:-$(npm root -g 2>/dev/null)}" node measure_heap.js web tetris.html 5) &&
+        PEAK_HEAP=$(echo "$MEASURED" | sed -n 's/.*peak_heap=\([0-9]*\).*/\1/p')
+fi
+if [ -n "$PEAK_HEAP" ]; then
+    echo "   $MEASURED"
+    # Valore consigliato: picco + 25%, arrotondato a pagine da 64 KiB
+    # Suggested value: peak + 25%, rounded up to 64 KiB pages
+    TUNED=$(( (PEAK_HEAP + PEAK_HEAP / 4 + 65535) / 65536 * 65536 ))
+    CURRENT=$(echo "$MEMORY_FLAGS" | sed 's/.*INITIAL_MEMORY=//')
+    echo "   INITIAL_MEMORY=$CURRENT, consigliato / suggested $TUNED"
+    if [ "$PEAK_HEAP" -gt "$CURRENT" ]; then
+        echo "   ⚠️  peak_heap supera INITIAL_MEMORY: la memoria cresce a runtime / exceeds INITIAL_MEMORY: memory grows at runtime"
+    fi
+else
+    echo "   Heap di picco non misurato: event=memory nella console, o Module._getPeakHeapBytes()"
+    echo "   Peak heap not measured: event=memory in the console, or Module._getPeakHeapBytes()"
+    if [ "${LEAN:-0}" = "1" ]; then
+        echo "   ⚠️  INITIAL_MEMORY=$LEAN_INITIAL_MEMORY è provvisorio / is provisional"
+    fi
+fi
 echo ""
 echo "🚀 Per testare localmente / To test locally:"
 echo "   cd web && python3 -m http.server 8000"
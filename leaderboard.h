@@ -0,0 +1,365 @@
+/*
+ * LEADERBOARD - Persistent local score store
+ * CLASSIFICA - Archivio locale persistente dei punteggi
+ *
+ * Finished games are appended to a memory-mapped, append-only log file.
+ * An in-memory top-K index (all-time and per level) is rebuilt from the
+ * log with one sequential pass at startup. Records are fixed size, so a
+ * corrupt one (failed checksum) is skipped and the pass resumes at the next
+ * record. Compaction bounds the file: it keeps every record a top-K index
+ * points to plus the newest N games, and drops corrupt records.
+ *
+ * Le partite finite vengono aggiunte a un log append-only mappato in
+ * memoria. Un indice top-K in memoria (assoluto e per livello) viene
+ * ricostruito all'avvio con una sola passata sequenziale. Un record corrotto
+ * viene saltato e la lettura riprende dal record successivo. La
+ * compattazione limita il file: conserva i record dell'indice top-K e le
+ * N partite più recenti, ed elimina i record corrotti.
+ *
+ * File layout / Struttura file:
+ *     [LogHeader 32 bytes][LeaderboardRecord 48 bytes] * record_count [unused capacity]
+ */
+
+#ifndef TETRIS_LEADERBOARD_H
+#define TETRIS_LEADERBOARD_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "log.h"
+
+// One finished game / Una partita finita
+struct LeaderboardRecord {
+    int32_t score;          // Final score / Punteggio finale
+    int32_t level;          // Level reached / Livello raggiunto
+    int32_t lines;          // Lines cleared / Linee eliminate
+    uint32_t duration_ms;   // Game duration / Durata partita
+    uint32_t seed;          // Piece sequence seed / Seme della sequenza pezzi
+    uint32_t checksum;      // Integrity check (torn writes) / Controllo integrità (scritture parziali)
+    uint64_t replay_ref;    // Spectator stream offset + 1, 0 = not recorded / Offset nel flusso spettatori + 1, 0 = non registrata
+    int64_t timestamp;      // Unix time at game over / Ora Unix al game over
+    uint64_t reserved;
+};
+static_assert(sizeof(LeaderboardRecord) == 48, "LeaderboardRecord layout is part of the file format");
+
+class Leaderboard {
+public:
+    static constexpr size_t DEFAULT_TOP_K = 100;
+
+    explicit Leaderboard(size_t top_k = DEFAULT_TOP_K)
+        : top_k(top_k), fd(-1), map_base(nullptr), map_size(0), corrupt_count(0) {}
+
+    ~Leaderboard() {
+        close();
+    }
+
+    Leaderboard(const Leaderboard&) = delete;
+    Leaderboard& operator=(const Leaderboard&) = delete;
+
+    // Open (or create) the log and rebuild the index / Apre (o crea) il log e ricostruisce l'indice
+    bool open(const std::string& log_path) {
+        close();
+        path = log_path;
+
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) {
+            TLOG_WARN("leaderboard_open_failed", tlog::kv("path", path.c_str()));
+            return false;
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close();
+            return false;
+        }
+
+        size_t file_size = static_cast<size_t>(st.st_size);
+        if (file_size < sizeof(LogHeader)) {
+            // New or truncated file: start an empty log / File nuovo o troncato: log vuoto
+            if (!mapFile(capacityFor(INITIAL_CAPACITY))) return false;
+            LogHeader* h = header();
+            std::memcpy(h->magic, LOG_MAGIC, sizeof(h->magic));
+            h->version = LOG_VERSION;
+            h->record_size = sizeof(LeaderboardRecord);
+            h->record_count = 0;
+            return true;
+        }
+
+        if (!mapFile(file_size)) return false;
+        const LogHeader* h = header();
+        if (std::memcmp(h->magic, LOG_MAGIC, sizeof(h->magic)) != 0 ||
+            h->version != LOG_VERSION || h->record_size != sizeof(LeaderboardRecord)) {
+            TLOG_WARN("leaderboard_bad_format", tlog::kv("path", path.c_str()));
+            close();
+            return false;
+        }
+
+        rebuildIndex();
+        return true;
+    }
+
+    void close() {
+        if (map_base) {
+            msync(map_base, map_size, MS_ASYNC);
+            munmap(map_base, map_size);
+            map_base = nullptr;
+            map_size = 0;
+        }
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+        all_time.clear();
+        per_level.clear();
+        corrupt_count = 0;
+    }
+
+    bool isOpen() const {
+        return map_base != nullptr;
+    }
+
+    // Append a finished game and index it / Aggiunge una partita finita e la indicizza
+    bool append(LeaderboardRecord record) {
+        if (!isOpen()) return false;
+
+        uint64_t index = header()->record_count;
+        size_t needed = sizeof(LogHeader) + (index + 1) * sizeof(LeaderboardRecord);
+        if (needed > map_size && !mapFile(capacityFor((index + 1) * 2))) return false;
+
+        // Write the record first, then publish it by bumping the count
+        // Scrive prima il record, poi lo pubblica incrementando il contatore
+        record.checksum = 0;
+        record.checksum = checksumOf(record);
+        records()[index] = record;
+        header()->record_count = index + 1;
+
+        indexRecord(index);
+        return true;
+    }
+
+    // Best records, all-time (level < 0) or for one level; O(log K) to locate
+    // Migliori record, assoluti (level < 0) o per un livello; O(log K) per la ricerca
+    std::vector<LeaderboardRecord> top(size_t count, int level = -1) const {
+        std::vector<LeaderboardRecord> result;
+        const TopSet* set = indexFor(level);
+        if (!set) return result;
+        for (auto it = set->begin(); it != set->end() && result.size() < count; ++it) {
+            result.push_back(records()[it->index]);
+        }
+        return result;
+    }
+
+    // Best score, all-time or for one level (0 if none) / Miglior punteggio (0 se assente)
+    int bestScore(int level = -1) const {
+        const TopSet* set = indexFor(level);
+        return (set && !set->empty()) ? set->begin()->score : 0;
+    }
+
+    // Would this score enter the top K? / Questo punteggio entrerebbe nella top K?
+    bool qualifies(int score, int level = -1) const {
+        const TopSet* set = indexFor(level);
+        return !set || set->size() < top_k || score > set->rbegin()->score;
+    }
+
+    uint64_t recordCount() const {
+        return isOpen() ? header()->record_count : 0;
+    }
+
+    // Records skipped at open because of a bad checksum / Record saltati all'apertura per checksum errato
+    uint64_t corruptCount() const {
+        return corrupt_count;
+    }
+
+    // Compact when there is corrupt data, or once the log passes 1.5x the retention cap
+    // Compatta se ci sono dati corrotti, o quando il log supera 1,5 volte il limite di conservazione
+    bool compactIfNeeded(uint64_t max_records) {
+        if (corrupt_count == 0 && recordCount() <= max_records + max_records / 2) return true;
+        return compact(max_records);
+    }
+
+    // Rewrite the log with the records the top-K indexes point to plus the newest `max_records`,
+    // in their original order; corrupt records are dropped. One streaming pass, memory O(K per level)
+    // Riscrive il log con i record dell'indice top-K più gli ultimi `max_records`, in ordine
+    // originale; i record corrotti vengono eliminati. Una passata in streaming, memoria O(K per livello)
+    bool compact(uint64_t max_records) {
+        if (!isOpen()) return false;
+
+        std::set<uint64_t> ranked;
+        for (const TopEntry& entry : all_time) ranked.insert(entry.index);
+        for (const auto& level : per_level) {
+            for (const TopEntry& entry : level.second) ranked.insert(entry.index);
+        }
+        uint64_t count = header()->record_count;
+        uint64_t recent_from = count > max_records ? count - max_records : 0;
+
+        std::string tmp_path = path + ".compact";
+        FILE* out = std::fopen(tmp_path.c_str(), "wb");
+        if (!out) {
+            TLOG_WARN("leaderboard_write_failed", tlog::kv("path", tmp_path.c_str()));
+            return false;
+        }
+        LogHeader h = *header();
+        h.record_count = 0;
+        bool ok = std::fwrite(&h, sizeof(h), 1, out) == 1;
+        for (uint64_t i = 0; i < count && ok; ++i) {
+            const LeaderboardRecord& r = records()[i];
+            if (!isValid(r) || (i < recent_from && !ranked.count(i))) continue;
+            ok = std::fwrite(&r, sizeof(r), 1, out) == 1;
+            h.record_count++;
+        }
+        // Publish the count once every record is written / Pubblica il conteggio a record scritti
+        ok = ok && std::fseek(out, 0, SEEK_SET) == 0 && std::fwrite(&h, sizeof(h), 1, out) == 1;
+        ok = (std::fflush(out) == 0) && ok && fsync(fileno(out)) == 0;
+        std::fclose(out);
+
+        if (!ok || std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+            TLOG_WARN("leaderboard_compact_failed", tlog::kv("path", path.c_str()));
+            std::remove(tmp_path.c_str());
+            return false;
+        }
+        TLOG_INFO("leaderboard_compacted", tlog::kv("records", h.record_count),
+                  tlog::kv("dropped", count - h.record_count));
+        return open(path);
+    }
+
+private:
+    static constexpr const char* LOG_MAGIC = "TTRSLOG1";  // 8 bytes, no terminator stored
+    static constexpr uint32_t LOG_VERSION = 1;
+    static constexpr uint64_t INITIAL_CAPACITY = 256;  // Records / Record
+
+    struct LogHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t record_size;
+        uint64_t record_count;  // Committed records / Record confermati
+        uint64_t reserved;
+    };
+    static_assert(sizeof(LogHeader) == 32, "LogHeader layout is part of the file format");
+
+    // Index entry: highest score first, earlier game wins ties
+    // Voce dell'indice: punteggio più alto prima, a parità vince la partita precedente
+    struct TopEntry {
+        int32_t score;
+        uint64_t index;
+        bool operator<(const TopEntry& other) const {
+            return score != other.score ? score > other.score : index < other.index;
+        }
+    };
+    using TopSet = std::set<TopEntry>;
+
+    size_t top_k;
+    std::string path;
+    int fd;
+    unsigned char* map_base;
+    size_t map_size;
+    TopSet all_time;
+    std::map<int, TopSet> per_level;
+    uint64_t corrupt_count;
+
+    LogHeader* header() const {
+        return reinterpret_cast<LogHeader*>(map_base);
+    }
+
+    LeaderboardRecord* records() const {
+        return reinterpret_cast<LeaderboardRecord*>(map_base + sizeof(LogHeader));
+    }
+
+    static size_t capacityFor(uint64_t record_capacity) {
+        return sizeof(LogHeader) + record_capacity * sizeof(LeaderboardRecord);
+    }
+
+    // (Re)map the file with the given size, growing it if needed
+    // (Ri)mappa il file con la dimensione data, ingrandendolo se necessario
+    bool mapFile(size_t size) {
+        if (map_base) {
+            munmap(map_base, map_size);
+            map_base = nullptr;
+            map_size = 0;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (static_cast<size_t>(st.st_size) < size && ftruncate(fd, size) != 0)) {
+            TLOG_WARN("leaderboard_resize_failed", tlog::kv("path", path.c_str()));
+            return false;
+        }
+        void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (base == MAP_FAILED) {
+            TLOG_WARN("leaderboard_map_failed", tlog::kv("path", path.c_str()));
+            return false;
+        }
+        map_base = static_cast<unsigned char*>(base);
+        map_size = size;
+        return true;
+    }
+
+    // FNV-1a over the record bytes / FNV-1a sui byte del record
+    static uint32_t checksumOf(const LeaderboardRecord& record) {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&record);
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < sizeof(record); ++i) {
+            hash = (hash ^ bytes[i]) * 16777619u;
+        }
+        return hash ? hash : 1;
+    }
+
+    static bool isValid(const LeaderboardRecord& record) {
+        LeaderboardRecord copy = record;
+        copy.checksum = 0;
+        return checksumOf(copy) == record.checksum;
+    }
+
+    // One sequential pass over the log / Una passata sequenziale sul log
+    void rebuildIndex() {
+        all_time.clear();
+        per_level.clear();
+        corrupt_count = 0;
+
+        uint64_t count = header()->record_count;
+        uint64_t capacity = (map_size - sizeof(LogHeader)) / sizeof(LeaderboardRecord);
+        if (count > capacity) count = capacity;
+
+        for (uint64_t i = 0; i < count; ++i) {
+            // Fixed-size records: skip a damaged one and carry on with the next
+            // Record a dimensione fissa: salta quello danneggiato e prosegue col successivo
+            if (!isValid(records()[i])) {
+                corrupt_count++;
+                continue;
+            }
+            indexRecord(i);
+        }
+        if (corrupt_count) {
+            TLOG_WARN("leaderboard_corrupt_records", tlog::kv("skipped", corrupt_count), tlog::kv("records", count));
+        }
+        header()->record_count = count;
+    }
+
+    void indexRecord(uint64_t index) {
+        const LeaderboardRecord& r = records()[index];
+        insertBounded(all_time, {r.score, index});
+        insertBounded(per_level[r.level], {r.score, index});
+    }
+
+    void insertBounded(TopSet& set, const TopEntry& entry) {
+        if (set.size() >= top_k && !(entry < *set.rbegin())) return;
+        set.insert(entry);
+        if (set.size() > top_k) set.erase(std::prev(set.end()));
+    }
+
+    const TopSet* indexFor(int level) const {
+        if (level < 0) return &all_time;
+        auto it = per_level.find(level);
+        return it == per_level.end() ? nullptr : &it->second;
+    }
+};
+
+#endif // TETRIS_LEADERBOARD_H
@@ -0,0 +1,316 @@
+/*
+ * LOGGING - Asynchronous structured logging
+ * LOGGING - Log strutturato asincrono
+ *
+ * Log calls copy a fixed-size entry (event name + up to 4 key/value
+ * fields) into a lock-free ring buffer and return; formatting and I/O
+ * happen on a background thread on desktop, or in flush() at the end of
+ * the frame on the web, where there are no threads. When the ring is full
+ * entries are dropped and counted instead of blocking the game thread.
+ *
+ * Le chiamate di log copiano una voce di dimensione fissa nel ring buffer
+ * lock-free e ritornano subito; formattazione e I/O avvengono in un thread
+ * in background su desktop, o in flush() a fine frame sul web.
+ *
+ * Levels below TETRIS_LOG_LEVEL are removed by the preprocessor, arguments
+ * included. Default: debug, or info when NDEBUG is defined.
+ * I livelli sotto TETRIS_LOG_LEVEL vengono rimossi dal preprocessore.
+ *
+ * Usage / Uso:
+ *     TLOG_INFO("game_over", tlog::kv("score", score), tlog::kv("game_level", level));
+ * Output (logfmt):
+ *     t=12.345 level=info event=game_over score=1200 game_level=3
+ * "t", "level" and "event" are reserved keys / "t", "level" e "event" sono chiavi riservate
+ * String values are quoted and escaped / I valori stringa sono tra virgolette e con escape
+ */
+
+#ifndef TETRIS_LOG_H
+#define TETRIS_LOG_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#ifndef __EMSCRIPTEN__
+#include <thread>
+#endif
+
+#define TLOG_LEVEL_DEBUG 1
+#define TLOG_LEVEL_INFO  2
+#define TLOG_LEVEL_WARN  3
+#define TLOG_LEVEL_ERROR 4
+#define TLOG_LEVEL_OFF   5
+
+#ifndef TETRIS_LOG_LEVEL
+#ifdef NDEBUG
+#define TETRIS_LOG_LEVEL TLOG_LEVEL_INFO
+#else
+#define TETRIS_LOG_LEVEL TLOG_LEVEL_DEBUG
+#endif
+#endif
+
+namespace tlog {
+
+// One key/value pair; strings are copied (truncated) so callers can pass temporaries
+// Una coppia chiave/valore; le stringhe vengono copiate (troncate)
+struct Field {
+    static constexpr size_t MAX_STRING = 40;
+
+    const char* key;  // Must be a string literal / Deve essere un letterale
+    bool is_string;
+    int64_t number;
+    char text[MAX_STRING];
+};
+
+inline Field kv(const char* key, int64_t value) {
+    Field f;
+    f.key = key;
+    f.is_string = false;
+    f.number = value;
+    f.text[0] = '\0';
+    return f;
+}
+
+inline Field kv(const char* key, int value) { return kv(key, static_cast<int64_t>(value)); }
+inline Field kv(const char* key, unsigned int value) { return kv(key, static_cast<int64_t>(value)); }
+inline Field kv(const char* key, uint64_t value) { return kv(key, static_cast<int64_t>(value)); }
+inline Field kv(const char* key, bool value) { return kv(key, static_cast<int64_t>(value)); }
+
+inline Field kv(const char* key, const char* value) {
+    Field f;
+    f.key = key;
+    f.is_string = true;
+    f.number = 0;
+    std::strncpy(f.text, value ? value : "", Field::MAX_STRING - 1);
+    f.text[Field::MAX_STRING - 1] = '\0';
+    return f;
+}
+
+class Logger {
+public:
+    static constexpr size_t MAX_FIELDS = 4;
+    static constexpr size_t CAPACITY = 256;  // Entries, power of two / Voci, potenza di due
+
+    static Logger& get() {
+        static Logger logger;
+        return logger;
+    }
+
+    // Enqueue an entry; never blocks / Accoda una voce; non blocca mai
+    template <typename... Fields>
+    void write(int level, const char* event, const Fields&... fields) {
+        static_assert(sizeof...(Fields) <= MAX_FIELDS, "too many log fields");
+
+        size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &slots[pos & (CAPACITY - 1)];
+            size_t seq = slot->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                dropped.fetch_add(1, std::memory_order_relaxed);  // Ring full / Ring pieno
+                return;
+            } else {
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        Entry& e = slot->entry;
+        e.time_us = elapsedMicros();
+        e.level = level;
+        e.event = event;
+        e.field_count = 0;
+        const Field list[] = {fields..., Field()};
+        for (size_t i = 0; i < sizeof...(Fields); ++i) {
+            e.fields[e.field_count++] = list[i];
+        }
+        slot->sequence.store(pos + 1, std::memory_order_release);
+    }
+
+    // Format and print everything queued so far (single consumer)
+    // Formatta e stampa tutto ciò che è in coda (consumatore singolo)
+    void flush() {
+        bool wrote = false;
+        for (;;) {
+            Slot* slot = &slots[dequeue_pos & (CAPACITY - 1)];
+            if (slot->sequence.load(std::memory_order_acquire) != dequeue_pos + 1) break;
+            print(slot->entry, info_out.load(std::memory_order_relaxed));
+            slot->sequence.store(dequeue_pos + CAPACITY, std::memory_order_release);
+            dequeue_pos++;
+            wrote = true;
+        }
+        size_t lost = dropped.exchange(0, std::memory_order_relaxed);
+        if (lost) {
+            std::fprintf(stderr, "level=warn event=log_dropped count=%zu\n", lost);
+            wrote = true;
+        }
+        if (wrote) std::fflush(info_out.load(std::memory_order_relaxed));
+    }
+
+#ifndef __EMSCRIPTEN__
+    // Where debug and info lines go, stdout by default; warnings and errors always use stderr
+    // Dove vanno le righe debug e info, stdout di default; warning ed errori sempre su stderr
+    void setOutput(std::FILE* out) {
+        info_out.store(out, std::memory_order_relaxed);
+    }
+
+    // Start draining on a background thread / Avvia lo svuotamento in un thread in background
+    void startWriter() {
+        if (writer.joinable()) return;
+        running.store(true);
+        writer = std::thread([this] {
+            while (running.load(std::memory_order_relaxed)) {
+                flush();
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+            flush();
+        });
+    }
+
+    void stopWriter() {
+        if (!writer.joinable()) return;
+        running.store(false);
+        writer.join();
+    }
+#endif
+
+private:
+    struct Entry {
+        uint64_t time_us;
+        int level;
+        const char* event;
+        size_t field_count;
+        Field fields[MAX_FIELDS];
+    };
+
+    // Bounded MPSC queue slot (Vyukov) / Slot della coda MPSC limitata (Vyukov)
+    struct Slot {
+        std::atomic<size_t> sequence;
+        Entry entry;
+    };
+
+    Slot slots[CAPACITY];
+    std::atomic<size_t> enqueue_pos;
+    size_t dequeue_pos;
+    std::atomic<size_t> dropped;
+    std::atomic<std::FILE*> info_out;
+    std::chrono::steady_clock::time_point start_time;
+#ifndef __EMSCRIPTEN__
+    std::thread writer;
+    std::atomic<bool> running;
+#endif
+
+    Logger() : enqueue_pos(0), dequeue_pos(0), dropped(0), info_out(stdout), start_time(std::chrono::steady_clock::now()) {
+        for (size_t i = 0; i < CAPACITY; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+#ifndef __EMSCRIPTEN__
+        running.store(false);
+#endif
+    }
+
+    ~Logger() {
+#ifndef __EMSCRIPTEN__
+        stopWriter();
+#endif
+        flush();
+    }
+
+    uint64_t elapsedMicros() const {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start_time).count();
+    }
+
+    static const char* levelName(int level) {
+        switch (level) {
+            case TLOG_LEVEL_DEBUG: return "debug";
+            case TLOG_LEVEL_INFO:  return "info";
+            case TLOG_LEVEL_WARN:  return "warn";
+            default:               return "error";
+        }
+    }
+
+    // Quoted logfmt value: backslash, quote and control characters escaped; returns the length written
+    // Valore logfmt tra virgolette: backslash, virgolette e caratteri di controllo con escape
+    static int appendQuoted(char* out, size_t size, const char* text) {
+        size_t n = 0;
+        auto put = [&](char c) {
+            if (n + 1 < size) out[n] = c;
+            n++;
+        };
+        put('"');
+        for (const char* p = text; *p; ++p) {
+            char c = *p;
+            if (c == '"' || c == '\\') {
+                put('\\');
+                put(c);
+            } else if (c == '\n') {
+                put('\\');
+                put('n');
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                put(' ');
+            } else {
+                put(c);
+            }
+        }
+        put('"');
+        out[n < size ? n : size - 1] = '\0';
+        return static_cast<int>(n);
+    }
+
+    // logfmt line; warnings and errors go to stderr / Riga logfmt; warning ed errori su stderr
+    static void print(const Entry& e, std::FILE* info) {
+        char line[512];
+        int len = std::snprintf(line, sizeof(line), "t=%llu.%03llu level=%s event=%s",
+                                static_cast<unsigned long long>(e.time_us / 1000000),
+                                static_cast<unsigned long long>((e.time_us / 1000) % 1000),
+                                levelName(e.level), e.event);
+        for (size_t i = 0; i < e.field_count && len > 0 && static_cast<size_t>(len) < sizeof(line); ++i) {
+            const Field& f = e.fields[i];
+            if (f.is_string) {
+                len += std::snprintf(line + len, sizeof(line) - len, " %s=", f.key);
+                if (len > 0 && static_cast<size_t>(len) < sizeof(line)) {
+                    len += appendQuoted(line + len, sizeof(line) - len, f.text);
+                }
+            } else {
+                len += std::snprintf(line + len, sizeof(line) - len, " %s=%lld", f.key,
+                                     static_cast<long long>(f.number));
+            }
+        }
+        std::FILE* out = e.level >= TLOG_LEVEL_WARN ? stderr : info;
+        std::fputs(line, out);
+        std::fputc('\n', out);
+    }
+};
+
+} // namespace tlog
+
+#if TETRIS_LOG_LEVEL <= TLOG_LEVEL_DEBUG
+#define TLOG_DEBUG(event, ...) ::tlog::Logger::get().write(TLOG_LEVEL_DEBUG, event, ##__VA_ARGS__)
+#else
+#define TLOG_DEBUG(event, ...) ((void)0)
+#endif
+
+#if TETRIS_LOG_LEVEL <= TLOG_LEVEL_INFO
+#define TLOG_INFO(event, ...) ::tlog::Logger::get().write(TLOG_LEVEL_INFO, event, ##__VA_ARGS__)
+#else
+#define TLOG_INFO(event, ...) ((void)0)
+#endif
+
+#if TETRIS_LOG_LEVEL <= TLOG_LEVEL_WARN
+#define TLOG_WARN(event, ...) ::tlog::Logger::get().write(TLOG_LEVEL_WARN, event, ##__VA_ARGS__)
+#else
+#define TLOG_WARN(event, ...) ((void)0)
+#endif
+
+#if TETRIS_LOG_LEVEL <= TLOG_LEVEL_ERROR
+#define TLOG_ERROR(event, ...) ::tlog::Logger::get().write(TLOG_LEVEL_ERROR, event, ##__VA_ARGS__)
+#else
+#define TLOG_ERROR(event, ...) ((void)0)
+#endif
+
+#endif // TETRIS_LOG_H
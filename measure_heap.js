@@ -0,0 +1,115 @@
+#!/usr/bin/env node
+/*
+ * MEASURE HEAP - Runs the web build headless and prints its peak heap
+ * MISURA HEAP - Esegue la build web senza finestra e stampa l'heap di picco
+ *
+ * Usage / Uso:
+ *     node measure_heap.js [dir] [page] [seconds]     (default: web tetris.html 5)
+ *
+ * Serves dir on a local port, opens page in headless Chrome (puppeteer), starts
+ * a game, lets it run for the given seconds and prints one logfmt line:
+ *     peak_heap=<bytes> wasm_memory=<bytes>
+ * peak_heap is the sbrk break (static data + stack + heap), the value
+ * INITIAL_MEMORY has to cover. Exit code 1 when it cannot be read.
+ * Serve dir su una porta locale, apre la pagina in Chrome headless, avvia una
+ * partita e stampa peak_heap (break di sbrk), il valore che INITIAL_MEMORY deve coprire.
+ */
+
+'use strict';
+
+const http = require('http');
+const fs = require('fs');
+const path = require('path');
+
+const dir = path.resolve(process.argv[2] || 'web');
+const page = process.argv[3] || 'tetris.html';
+const seconds = Number(process.argv[4] || 5);
+
+const MIME = {
+    '.html': 'text/html',
+    '.js': 'text/javascript',
+    '.wasm': 'application/wasm',
+    '.css': 'text/css',
+    '.svg': 'image/svg+xml',
+};
+
+function fail(message) {
+    console.error('measure_heap: ' + message);
+    process.exit(1);
+}
+
+let puppeteer;
+try {
+    puppeteer = require('puppeteer');
+} catch (e) {
+    fail('puppeteer not found (npm install -g puppeteer, then set NODE_PATH)');
+}
+
+// Static file server, enough for the Emscripten loader / Server statico, basta al loader di Emscripten
+const server = http.createServer((req, res) => {
+    const file = path.join(dir, decodeURIComponent(req.url.split('?')[0]));
+    if (!file.startsWith(dir)) {
+        res.writeHead(403);
+        res.end();
+        return;
+    }
+    fs.readFile(file, (err, data) => {
+        if (err) {
+            res.writeHead(404);
+            res.end();
+            return;
+        }
+        res.writeHead(200, { 'Content-Type': MIME[path.extname(file)] || 'application/octet-stream' });
+        res.end(data);
+    });
+});
+
+function sleep(ms) {
+    return new Promise(resolve => setTimeout(resolve, ms));
+}
+
+async function main() {
+    await new Promise(resolve => server.listen(0, '127.0.0.1', resolve));
+    const url = 'http://127.0.0.1:' + server.address().port + '/' + page;
+
+    const browser = await puppeteer.launch({
+        headless: 'shell',
+        args: ['--no-sandbox', '--autoplay-policy=no-user-gesture-required'],
+    });
+    try {
+        const tab = await browser.newPage();
+        // The game logs event=memory once setup is done / Il gioco scrive event=memory a fine setup
+        let startup = null;
+        tab.on('console', msg => {
+            const text = msg.text();
+            if (text.includes('event=memory')) startup = text;
+        });
+        await tab.goto(url, { waitUntil: 'load' });
+
+        const ready = await tab.waitForFunction(
+            () => typeof Module !== 'undefined' && typeof Module._getPeakHeapBytes === 'function',
+            { timeout: 30000 }).then(() => true, () => false);
+        if (!ready) {
+            fail(startup ? 'only the startup value is available: ' + startup
+                         : 'Module._getPeakHeapBytes is missing (build predates it?)');
+        }
+
+        // Play for a while so the music and the game loop allocations count too
+        // Gioca per un po' così contano anche musica e allocazioni del ciclo di gioco
+        await tab.evaluate(() => {
+            if (typeof Module._startTetrisGame === 'function') Module._startTetrisGame();
+        });
+        await sleep(seconds * 1000);
+
+        const result = await tab.evaluate(() => ({
+            peak: Module._getPeakHeapBytes(),
+            memory: Module._getMemoryBytes ? Module._getMemoryBytes() : 0,
+        }));
+        console.log('peak_heap=' + result.peak + ' wasm_memory=' + result.memory);
+    } finally {
+        await browser.close();
+        server.close();
+    }
+}
+
+main().catch(err => fail(err.message));
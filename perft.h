@@ -0,0 +1,262 @@
+/*
+ * PERFT - Reachable board state counter
+ * PERFT - Contatore degli stati di gioco raggiungibili
+ *
+ * Like chess "perft": walks the tree of every way to place the next N
+ * pieces of a fixed sequence and counts the leaves. Movement follows
+ * handleInput/checkCollision exactly: left, right, clockwise rotation
+ * without wall kicks, soft drop, and a lock when the piece cannot move
+ * down. A locked piece is placed, full rows are cleared and a board with
+ * blocks in the top row ends the game (no further children).
+ * Children of a node are deduplicated: different lock positions that
+ * leave the same board count once.
+ *
+ * Come il "perft" degli scacchi: esplora l'albero di tutti i modi di
+ * piazzare i prossimi N pezzi di una sequenza fissa e conta le foglie,
+ * con le stesse regole di handleInput/checkCollision.
+ *
+ * Subtree counts are memoized in a per-thread transposition table and the
+ * first-ply branches are split across worker threads.
+ * I conteggi dei sottoalberi sono memorizzati in una tabella di
+ * trasposizione per thread; i rami del primo livello sono divisi tra thread.
+ */
+
+#ifndef TETRIS_PERFT_H
+#define TETRIS_PERFT_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+class Perft {
+public:
+    static constexpr int WIDTH = 10;   // Must match GRID_WIDTH / Deve coincidere con GRID_WIDTH
+    static constexpr int HEIGHT = 20;  // Must match GRID_HEIGHT / Deve coincidere con GRID_HEIGHT
+    static constexpr int SPAWN_X = WIDTH / 2 - 2;  // As spawnPiece / Come spawnPiece
+    static constexpr int SPAWN_Y = -2;
+
+    using ShapeTable = std::array<std::array<std::array<int, 16>, 4>, 7>;
+
+    // Occupancy only: colors do not affect what is reachable
+    // Solo occupazione: i colori non influenzano ciò che è raggiungibile
+    struct Board {
+        std::array<uint16_t, HEIGHT> rows;  // Bit x set = cell (x, y) filled / Bit x = cella piena
+        bool game_over;
+
+        Board() : game_over(false) { rows.fill(0); }
+
+        bool operator==(const Board& other) const {
+            return rows == other.rows && game_over == other.game_over;
+        }
+
+        uint64_t hash() const {
+            uint64_t h = game_over ? 0x9e3779b97f4a7c15ull : 0;
+            for (uint16_t row : rows) {
+                h = (h ^ row) * 0x100000001b3ull;
+                h ^= h >> 29;
+            }
+            return h;
+        }
+    };
+
+    Perft(const ShapeTable& shapes, std::vector<int> sequence, size_t tt_bytes_per_thread, unsigned threads)
+        : sequence(std::move(sequence)), threads(threads ? threads : 1) {
+        // Pre-extract the 4 cells of every shape / Estrae le 4 celle di ogni forma
+        for (int t = 0; t < 7; ++t) {
+            for (int r = 0; r < 4; ++r) {
+                int n = 0;
+                for (int i = 0; i < 16; ++i) {
+                    if (shapes[t][r][i] && n < 4) {
+                        cells[t][r][n][0] = i % 4;
+                        cells[t][r][n][1] = i / 4;
+                        n++;
+                    }
+                }
+            }
+        }
+        tt_entries = 1;
+        while (tt_entries * 2 * sizeof(TTEntry) <= tt_bytes_per_thread) tt_entries *= 2;
+    }
+
+    // Parse "IJLOSTZ"-style piece letters / Interpreta lettere dei pezzi come "IJLOSTZ"
+    static bool parseSequence(const std::string& text, std::vector<int>& out) {
+        static const char letters[] = "IJLOSTZ";
+        out.clear();
+        for (char c : text) {
+            const char* p = std::strchr(letters, c & ~0x20);
+            if (!p || !*p) return false;
+            out.push_back(static_cast<int>(p - letters));
+        }
+        return !out.empty();
+    }
+
+    // Leaf count at exactly `depth` pieces / Numero di foglie a esattamente `depth` pezzi
+    uint64_t count(const Board& root, int depth) {
+        if (depth <= 0) return 1;
+
+        std::vector<Board> first;
+        generate(root, pieceAt(0), first);
+        if (depth == 1) return first.size();
+
+        std::atomic<size_t> next(0);
+        std::atomic<uint64_t> total(0);
+        std::vector<std::thread> workers;
+        unsigned n = std::min<unsigned>(threads, static_cast<unsigned>(first.size()));
+        for (unsigned w = 0; w < n; ++w) {
+            workers.emplace_back([&] {
+                Worker worker(tt_entries, depth);
+                uint64_t sum = 0;
+                for (size_t i = next++; i < first.size(); i = next++) {
+                    sum += search(worker, first[i], 1, depth - 1);
+                }
+                total += sum;
+            });
+        }
+        for (auto& t : workers) t.join();
+        return total.load();
+    }
+
+    // All boards reachable by placing one piece of `type` / Tutte le griglie raggiungibili piazzando un pezzo
+    void generate(const Board& board, int type, std::vector<Board>& out) const {
+        out.clear();
+        if (board.game_over) return;
+
+        // BFS over (rotation, y, x) from the spawn position / BFS su (rotazione, y, x) dalla posizione iniziale
+        constexpr int X_MIN = -4, Y_MIN = -4;
+        constexpr int XS = WIDTH + 8, YS = HEIGHT + 8;
+        bool visited[4][YS][XS];
+        std::memset(visited, 0, sizeof(visited));
+
+        struct State { int8_t x, y, rot; };
+        State queue[4 * YS * XS];
+        size_t head = 0, tail = 0;
+        queue[tail++] = {SPAWN_X, SPAWN_Y, 0};
+        visited[0][SPAWN_Y - Y_MIN][SPAWN_X - X_MIN] = true;
+
+        std::vector<uint64_t> seen;
+        while (head < tail) {
+            State s = queue[head++];
+
+            // Gravity locks the piece when it cannot move down / La gravità blocca il pezzo se non può scendere
+            if (collides(board, type, s.x, s.y + 1, s.rot)) {
+                Board child = lock(board, type, s.x, s.y, s.rot);
+                uint64_t h = child.hash();
+                bool duplicate = false;
+                for (size_t i = 0; i < seen.size() && !duplicate; ++i) {
+                    duplicate = seen[i] == h && out[i] == child;
+                }
+                if (!duplicate) {
+                    seen.push_back(h);
+                    out.push_back(child);
+                }
+            }
+
+            const State moves[4] = {
+                {static_cast<int8_t>(s.x - 1), s.y, s.rot},                        // LEFT
+                {static_cast<int8_t>(s.x + 1), s.y, s.rot},                        // RIGHT
+                {s.x, s.y, static_cast<int8_t>((s.rot + 1) % 4)},                  // UP
+                {s.x, static_cast<int8_t>(s.y + 1), s.rot}                         // DOWN
+            };
+            for (const State& m : moves) {
+                if (m.x < X_MIN || m.x >= X_MIN + XS || m.y < Y_MIN || m.y >= Y_MIN + YS) continue;
+                bool& v = visited[m.rot][m.y - Y_MIN][m.x - X_MIN];
+                if (v || collides(board, type, m.x, m.y, m.rot)) continue;
+                v = true;
+                queue[tail++] = m;
+            }
+        }
+    }
+
+    // Same test as TetrisGame::checkCollision / Stesso test di TetrisGame::checkCollision
+    bool collides(const Board& board, int type, int x, int y, int rot) const {
+        for (int i = 0; i < 4; ++i) {
+            int gx = x + cells[type][rot][i][0];
+            int gy = y + cells[type][rot][i][1];
+            if (gy < 0) continue;
+            if (gx < 0 || gx >= WIDTH || gy >= HEIGHT) return true;
+            if (board.rows[gy] & (1u << gx)) return true;
+        }
+        return false;
+    }
+
+    // placePiece + clearLines + isGameOver / placePiece + clearLines + isGameOver
+    Board lock(const Board& board, int type, int x, int y, int rot) const {
+        Board next = board;
+        for (int i = 0; i < 4; ++i) {
+            int gx = x + cells[type][rot][i][0];
+            int gy = y + cells[type][rot][i][1];
+            if (gy >= 0 && gy < HEIGHT && gx >= 0 && gx < WIDTH) {
+                next.rows[gy] |= static_cast<uint16_t>(1u << gx);
+            }
+        }
+        constexpr uint16_t FULL = (1u << WIDTH) - 1;
+        int dst = HEIGHT - 1;
+        for (int src = HEIGHT - 1; src >= 0; --src) {
+            if (next.rows[src] != FULL) next.rows[dst--] = next.rows[src];
+        }
+        while (dst >= 0) next.rows[dst--] = 0;
+        next.game_over = next.rows[0] != 0;
+        return next;
+    }
+
+    int pieceAt(int ply) const {
+        return sequence[ply % sequence.size()];
+    }
+
+private:
+    struct TTEntry {
+        Board board;
+        int32_t ply;  // -1 = empty / -1 = vuota
+        uint64_t count;
+    };
+
+    struct Worker {
+        std::vector<TTEntry> table;
+        std::vector<std::vector<Board>> children;  // Scratch per ply / Buffer per livello
+
+        // Scratch buffers are sized up front so references stay valid while recursing
+        // I buffer sono dimensionati subito così i riferimenti restano validi nella ricorsione
+        Worker(size_t entries, int max_ply) : table(entries), children(max_ply + 1) {
+            for (auto& e : table) e.ply = -1;
+        }
+    };
+
+    std::vector<int> sequence;
+    unsigned threads;
+    size_t tt_entries;
+    int8_t cells[7][4][4][2];
+
+    // With a fixed sequence, (board, ply) determines the subtree / Con sequenza fissa, (griglia, ply) determina il sottoalbero
+    uint64_t search(Worker& w, const Board& board, int ply, int depth) {
+        if (depth == 0) return 1;
+        if (board.game_over) return 0;
+
+        TTEntry& slot = w.table[(board.hash() ^ (static_cast<uint64_t>(ply) * 0x9e3779b97f4a7c15ull)) & (tt_entries - 1)];
+        if (slot.ply == ply && slot.board == board) return slot.count;
+
+        std::vector<Board>& kids = w.children[ply];
+        generate(board, pieceAt(ply), kids);
+
+        uint64_t sum = 0;
+        if (depth == 1) {
+            sum = kids.size();
+        } else {
+            for (const Board& child : kids) {
+                sum += search(w, child, ply + 1, depth - 1);
+            }
+        }
+
+        // Always replace: deeper nodes overwrite shallower ones / Sostituzione sempre
+        slot.board = board;
+        slot.ply = ply;
+        slot.count = sum;
+        return sum;
+    }
+};
+
+#endif // TETRIS_PERFT_H
@@ -0,0 +1,141 @@
+/*
+ * SFX SYNTH - Procedural sound effects
+ * SFX SYNTH - Effetti sonori procedurali
+ *
+ * Renders the game's sound effects into PCM buffers at startup from small
+ * parameter tables (waveform, pitch sweep, arpeggio, envelope), so the WAV
+ * files do not have to be downloaded and decoded. Buffers are wrapped as
+ * Mix_Chunk without copying and must outlive the chunks.
+ *
+ * Genera gli effetti sonori in buffer PCM all'avvio partendo da piccole
+ * tabelle di parametri, così i file WAV non vanno scaricati e decodificati.
+ * I buffer sono usati dai Mix_Chunk senza copia e devono sopravvivere ai chunk.
+ */
+
+#ifndef TETRIS_SFX_SYNTH_H
+#define TETRIS_SFX_SYNTH_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_mixer.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+class SfxSynth {
+public:
+    enum Sound { SOUND_ROTATE = 0, SOUND_CLEAR, SOUND_GAMEOVER, SOUND_MOVE, SOUND_COUNT };
+    enum Waveform { WAVE_SINE, WAVE_SQUARE, WAVE_TRIANGLE, WAVE_SAW, WAVE_NOISE };
+
+    // One effect / Un effetto
+    struct Params {
+        Waveform wave;
+        float freq_start;     // Hz at the start / Hz all'inizio
+        float freq_end;       // Hz at the end (exponential sweep) / Hz alla fine (sweep esponenziale)
+        float duration;       // Seconds / Secondi
+        float attack;         // Fade-in seconds / Secondi di fade-in
+        float release;        // Fade-out seconds / Secondi di fade-out
+        float volume;         // 0-1
+        float vibrato_hz;     // 0 = none / 0 = nessuno
+        float vibrato_depth;  // Fraction of pitch / Frazione dell'altezza
+        int arp_steps;        // Arpeggio notes, 1 = none / Note dell'arpeggio, 1 = nessuno
+        float arp_ratio;      // Pitch ratio between notes / Rapporto tra note
+    };
+
+    // Generate every effect in the mixer's output format; false if unsupported
+    // Genera ogni effetto nel formato di uscita del mixer; false se non supportato
+    bool generate() {
+        int frequency = 0, channels = 0;
+        Uint16 format = 0;
+        if (!Mix_QuerySpec(&frequency, &format, &channels) || format != AUDIO_S16SYS) {
+            return false;
+        }
+        for (int s = 0; s < SOUND_COUNT; ++s) {
+            render(params()[s], frequency, channels, buffers[s]);
+        }
+        return true;
+    }
+
+    // New chunk over the generated buffer (freed with Mix_FreeChunk, buffer stays here)
+    // Nuovo chunk sul buffer generato (liberato con Mix_FreeChunk, il buffer resta qui)
+    Mix_Chunk* chunk(Sound sound) {
+        std::vector<Sint16>& buf = buffers[sound];
+        if (buf.empty()) return nullptr;
+        return Mix_QuickLoad_RAW(reinterpret_cast<Uint8*>(buf.data()),
+                                 static_cast<Uint32>(buf.size() * sizeof(Sint16)));
+    }
+
+    static const std::array<Params, SOUND_COUNT>& params() {
+        static const std::array<Params, SOUND_COUNT> table = {{
+            // wave          start   end     dur    atk    rel    vol   vib   depth  arp ratio
+            {WAVE_TRIANGLE,  520.f,  780.f,  0.07f, 0.002f, 0.03f, 0.45f, 0.f,  0.f,   1, 1.f},       // Rotate
+            {WAVE_SQUARE,    523.f,  523.f,  0.36f, 0.002f, 0.12f, 0.30f, 0.f,  0.f,   4, 1.2599f},   // Clear (augmented arpeggio: stacked major thirds, C5 E5 G#5 C6)
+            {WAVE_SAW,       440.f,  98.f,   1.10f, 0.005f, 0.40f, 0.35f, 6.f,  0.03f, 1, 1.f},       // Game over
+            {WAVE_SQUARE,    180.f,  140.f,  0.035f, 0.001f, 0.02f, 0.20f, 0.f, 0.f,   1, 1.f},       // Move
+        }};
+        return table;
+    }
+
+private:
+    std::array<std::vector<Sint16>, SOUND_COUNT> buffers;
+
+    static void render(const Params& p, int frequency, int channels, std::vector<Sint16>& out) {
+        const double two_pi = 6.283185307179586;
+        int frames = static_cast<int>(p.duration * frequency);
+        out.assign(static_cast<size_t>(frames) * channels, 0);
+
+        double phase = 0.0;
+        uint32_t noise = 0x12345678u;
+        float noise_value = 0.0f;
+        double sweep = std::log(p.freq_end / p.freq_start);
+
+        for (int i = 0; i < frames; ++i) {
+            double t = static_cast<double>(i) / frequency;
+            double progress = static_cast<double>(i) / frames;
+
+            // Pitch: exponential sweep, arpeggio steps, vibrato / Altezza: sweep, arpeggio, vibrato
+            double freq = p.freq_start * std::exp(sweep * progress);
+            if (p.arp_steps > 1) {
+                int step = static_cast<int>(progress * p.arp_steps);
+                freq *= std::pow(p.arp_ratio, step);
+            }
+            if (p.vibrato_hz > 0.0f) {
+                freq *= 1.0 + p.vibrato_depth * std::sin(two_pi * p.vibrato_hz * t);
+            }
+
+            double prev_phase = phase;
+            phase += freq / frequency;
+            phase -= std::floor(phase);
+
+            float sample;
+            switch (p.wave) {
+                case WAVE_SINE:     sample = static_cast<float>(std::sin(two_pi * phase)); break;
+                case WAVE_SQUARE:   sample = phase < 0.5 ? 1.0f : -1.0f; break;
+                case WAVE_TRIANGLE: sample = static_cast<float>(4.0 * std::fabs(phase - 0.5) - 1.0); break;
+                case WAVE_SAW:      sample = static_cast<float>(2.0 * phase - 1.0); break;
+                default:
+                    // New noise value once per period / Nuovo valore di rumore a ogni periodo
+                    if (phase < prev_phase) {
+                        noise = noise * 1664525u + 1013904223u;
+                        noise_value = static_cast<float>(noise >> 8) / 8388608.0f - 1.0f;
+                    }
+                    sample = noise_value;
+                    break;
+            }
+
+            // Linear attack and release to avoid clicks / Attacco e rilascio lineari contro i click
+            float env = 1.0f;
+            float remaining = p.duration - static_cast<float>(t);
+            if (t < p.attack) env = static_cast<float>(t) / p.attack;
+            if (remaining < p.release) env = std::min(env, remaining / p.release);
+
+            Sint16 value = static_cast<Sint16>(sample * env * p.volume * 32767.0f);
+            for (int c = 0; c < channels; ++c) {
+                out[static_cast<size_t>(i) * channels + c] = value;
+            }
+        }
+    }
+};
+
+#endif // TETRIS_SFX_SYNTH_H
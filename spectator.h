@@ -0,0 +1,723 @@
+/*
+ * SPECTATOR - Delta-encoded broadcast stream
+ * SPETTATORI - Flusso di trasmissione con codifica delta
+ *
+ * Each frame the game hands over a snapshot of its state; the encoder
+ * compares it with the state the viewers already have and emits only
+ * the differences: single-byte piece moves, a one-byte "lock" that the
+ * viewer replays with the same placement and line-clear rules, changed
+ * rows, score and flags. A keyframe with the whole state is emitted at
+ * the start of every game and every KEYFRAME_INTERVAL_MS so viewers that
+ * join late (or lose data) can resynchronize.
+ *
+ * Ogni frame il gioco passa un'istantanea del proprio stato; il codificatore
+ * la confronta con lo stato già noto agli spettatori ed emette solo le
+ * differenze. Un keyframe con lo stato completo viene emesso a inizio
+ * partita e ogni KEYFRAME_INTERVAL_MS per chi si collega in ritardo.
+ *
+ * Stream layout / Struttura del flusso:
+ *     header: "TSPC" version width height, shape masks (7x4 u16), colors (7x3 u8)
+ *     messages: [op u8][payload], integers as LEB128 varints
+ * Rows are 10 cells of 3 bits (0 empty, 1-7 piece type + 1) in 4 bytes.
+ * Le righe sono 10 celle da 3 bit (0 vuota, 1-7 tipo pezzo + 1) in 4 byte.
+ *
+ * Targets / Destinazioni: a file or FIFO path, "-" for stdout, "unix:/path"
+ * for a listening Unix socket. Writes never block the game: a slow consumer
+ * loses frames and gets a keyframe as soon as it catches up.
+ */
+
+#ifndef TETRIS_SPECTATOR_H
+#define TETRIS_SPECTATOR_H
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace spectator {
+
+constexpr char MAGIC[4] = {'T', 'S', 'P', 'C'};
+constexpr uint8_t VERSION = 1;
+constexpr int WIDTH = 10;   // Must match GRID_WIDTH / Deve coincidere con GRID_WIDTH
+constexpr int HEIGHT = 20;  // Must match GRID_HEIGHT / Deve coincidere con GRID_HEIGHT
+constexpr int PIECES = 7;
+constexpr size_t HEADER_SIZE = 7 + PIECES * 4 * 2 + PIECES * 3;
+constexpr uint32_t KEYFRAME_INTERVAL_MS = 2000;
+constexpr char KEYFRAME_SYNC[3] = {'K', 'F', 'R'};  // Lets late joiners find a keyframe / Per trovare un keyframe a metà flusso
+
+enum Op : uint8_t {
+    OP_TIME = 1,      // varint ms since the previous frame / varint ms dal frame precedente
+    OP_KEYFRAME,      // sync, absolute ms, flags, score, level, lines, piece, row mask, non-empty rows
+    OP_NEW_GAME,      // varint seed
+    OP_ROWS,          // row mask, changed rows
+    OP_LOCK,          // place the piece and clear full rows / piazza il pezzo ed elimina le righe piene
+    OP_PIECE,         // type | rotation << 4, zigzag varint x, zigzag varint y
+    OP_PIECE_LEFT,
+    OP_PIECE_RIGHT,
+    OP_PIECE_DOWN,
+    OP_PIECE_ROTATE,
+    OP_STATS,         // varint score, level, lines
+    OP_FLAGS          // bit 0 game over, bit 1 paused / bit 0 game over, bit 1 pausa
+};
+
+// Everything a viewer needs to draw a frame / Tutto ciò che serve a uno spettatore per disegnare un frame
+struct State {
+    std::array<std::array<uint8_t, WIDTH>, HEIGHT> cells;  // 0 empty, 1-7 type + 1 / 0 vuota, 1-7 tipo + 1
+    int piece_type, piece_x, piece_y, piece_rotation;
+    uint32_t score, level, lines;
+    bool game_over, paused;
+
+    State() : piece_type(0), piece_x(0), piece_y(0), piece_rotation(0),
+              score(0), level(1), lines(0), game_over(false), paused(false) {
+        for (auto& row : cells) row.fill(0);
+    }
+
+    bool samePiece(const State& other) const {
+        return piece_type == other.piece_type && piece_x == other.piece_x &&
+               piece_y == other.piece_y && piece_rotation == other.piece_rotation;
+    }
+};
+
+// Shapes and colors, sent in the header so viewers need no game tables
+// Forme e colori, inviati nell'header così gli spettatori non dipendono dalle tabelle del gioco
+struct Rules {
+    uint16_t shapes[PIECES][4];    // Bit i = cell (i % 4, i / 4) / Bit i = cella (i % 4, i / 4)
+    uint8_t colors[PIECES][3];     // RGB
+
+    Rules() {
+        std::memset(shapes, 0, sizeof(shapes));
+        std::memset(colors, 0, sizeof(colors));
+    }
+
+    // placePiece + clearLines, as the game does them / placePiece + clearLines, come nel gioco
+    void lock(State& s) const {
+        uint16_t mask = shapes[s.piece_type][s.piece_rotation];
+        for (int i = 0; i < 16; ++i) {
+            if (!(mask & (1u << i))) continue;
+            int gx = s.piece_x + i % 4;
+            int gy = s.piece_y + i / 4;
+            if (gy >= 0 && gy < HEIGHT && gx >= 0 && gx < WIDTH) {
+                s.cells[gy][gx] = static_cast<uint8_t>(s.piece_type + 1);
+            }
+        }
+        int dst = HEIGHT - 1;
+        for (int src = HEIGHT - 1; src >= 0; --src) {
+            bool full = true;
+            for (uint8_t c : s.cells[src]) full = full && c != 0;
+            if (!full) s.cells[dst--] = s.cells[src];
+        }
+        while (dst >= 0) s.cells[dst--].fill(0);
+    }
+};
+
+// Low-level encoding helpers / Funzioni di codifica di basso livello
+inline void putVarint(std::vector<uint8_t>& out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+// Signed values as zigzag varints: 0, -1, 1, -2... / Valori con segno come varint zigzag: 0, -1, 1, -2...
+inline void putSigned(std::vector<uint8_t>& out, int32_t value) {
+    putVarint(out, (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31));
+}
+
+inline void putRow(std::vector<uint8_t>& out, const std::array<uint8_t, WIDTH>& row) {
+    uint32_t bits = 0;
+    for (int x = 0; x < WIDTH; ++x) bits |= static_cast<uint32_t>(row[x] & 7) << (3 * x);
+    for (int i = 0; i < 4; ++i) out.push_back(static_cast<uint8_t>(bits >> (8 * i)));
+}
+
+// Bounds-checked reader; `incomplete` means more bytes are needed
+// Lettore con controllo dei limiti; `incomplete` indica che servono altri byte
+struct Reader {
+    const uint8_t* pos;
+    const uint8_t* end;
+    bool incomplete;
+
+    Reader(const uint8_t* data, size_t size) : pos(data), end(data + size), incomplete(false) {}
+
+    uint8_t u8() {
+        if (pos >= end) {
+            incomplete = true;
+            return 0;
+        }
+        return *pos++;
+    }
+
+    uint32_t varint() {
+        uint32_t value = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            uint8_t b = u8();
+            value |= static_cast<uint32_t>(b & 0x7f) << shift;
+            if (!(b & 0x80)) break;
+        }
+        return value;
+    }
+
+    int32_t svarint() {
+        uint32_t value = varint();
+        return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+    }
+
+    void row(std::array<uint8_t, WIDTH>& out) {
+        uint32_t bits = 0;
+        for (int i = 0; i < 4; ++i) bits |= static_cast<uint32_t>(u8()) << (8 * i);
+        for (int x = 0; x < WIDTH; ++x) out[x] = static_cast<uint8_t>((bits >> (3 * x)) & 7);
+    }
+};
+
+class Encoder {
+public:
+    Encoder() : has_shadow(false), force_keyframe(true), new_game(false), seed(0),
+                last_time_ms(0), last_keyframe_ms(0), keyframes(0) {}
+
+    static void header(const Rules& table, std::vector<uint8_t>& out) {
+        out.insert(out.end(), MAGIC, MAGIC + 4);
+        out.push_back(VERSION);
+        out.push_back(WIDTH);
+        out.push_back(HEIGHT);
+        for (int t = 0; t < PIECES; ++t) {
+            for (int r = 0; r < 4; ++r) {
+                out.push_back(static_cast<uint8_t>(table.shapes[t][r]));
+                out.push_back(static_cast<uint8_t>(table.shapes[t][r] >> 8));
+            }
+        }
+        for (int t = 0; t < PIECES; ++t) out.insert(out.end(), table.colors[t], table.colors[t] + 3);
+    }
+
+    void setRules(const Rules& r) {
+        rules = r;
+    }
+
+    // Announce a new game; the next frame is a keyframe / Annuncia una nuova partita; il prossimo frame è un keyframe
+    void beginGame(uint32_t game_seed) {
+        new_game = true;
+        seed = game_seed;
+        force_keyframe = true;
+    }
+
+    // Resend the full state next frame (e.g. after dropped data) / Rimanda lo stato completo al prossimo frame
+    void requestKeyframe() {
+        force_keyframe = true;
+    }
+
+    // Append the messages that turn the viewers' state into `now` / Aggiunge i messaggi che portano gli spettatori a `now`
+    void encode(const State& now, uint32_t now_ms, std::vector<uint8_t>& out) {
+        scratch.clear();
+        if (new_game) {
+            scratch.push_back(OP_NEW_GAME);
+            putVarint(scratch, seed);
+            new_game = false;
+        }
+        bool full = !has_shadow || force_keyframe || now_ms - last_keyframe_ms >= KEYFRAME_INTERVAL_MS;
+        if (full) {
+            keyframe(now, now_ms);
+            last_keyframe_ms = now_ms;
+            force_keyframe = false;
+        } else {
+            delta(now);
+        }
+        if (scratch.empty()) return;
+
+        // Keyframes carry absolute time, so dropped frames cannot skew the clock
+        // I keyframe portano il tempo assoluto, così i frame persi non sfasano l'orologio
+        if (!full) {
+            out.push_back(OP_TIME);
+            putVarint(out, now_ms - last_time_ms);
+        }
+        last_time_ms = now_ms;
+        out.insert(out.end(), scratch.begin(), scratch.end());
+    }
+
+    uint32_t keyframeCount() const {
+        return keyframes;
+    }
+
+private:
+    Rules rules;
+    State shadow;  // What the viewers currently have / Ciò che gli spettatori hanno ora
+    bool has_shadow;
+    bool force_keyframe;
+    bool new_game;
+    uint32_t seed;
+    uint32_t last_time_ms;
+    uint32_t last_keyframe_ms;
+    uint32_t keyframes;
+    std::vector<uint8_t> scratch;  // Reused every frame / Riutilizzato a ogni frame
+
+    static uint8_t flags(const State& s) {
+        return static_cast<uint8_t>((s.game_over ? 1 : 0) | (s.paused ? 2 : 0));
+    }
+
+    void putPiece(const State& s) {
+        scratch.push_back(static_cast<uint8_t>(s.piece_type | (s.piece_rotation << 4)));
+        putSigned(scratch, s.piece_x);  // The wall quirk can push x far out / Il difetto del muro può spingere x molto fuori
+        putSigned(scratch, s.piece_y);
+    }
+
+    void putStats(const State& s) {
+        putVarint(scratch, s.score);
+        putVarint(scratch, s.level);
+        putVarint(scratch, s.lines);
+    }
+
+    void keyframe(const State& now, uint32_t now_ms) {
+        scratch.push_back(OP_KEYFRAME);
+        scratch.insert(scratch.end(), KEYFRAME_SYNC, KEYFRAME_SYNC + 3);
+        putVarint(scratch, now_ms);
+        scratch.push_back(flags(now));
+        putStats(now);
+        putPiece(now);
+
+        uint32_t mask = 0;
+        for (int y = 0; y < HEIGHT; ++y) {
+            for (uint8_t c : now.cells[y]) {
+                if (c) mask |= 1u << y;
+            }
+        }
+        putVarint(scratch, mask);
+        for (int y = 0; y < HEIGHT; ++y) {
+            if (mask & (1u << y)) putRow(scratch, now.cells[y]);
+        }
+        shadow = now;
+        has_shadow = true;
+        keyframes++;
+    }
+
+    void delta(const State& now) {
+        if (now.cells != shadow.cells) {
+            // Most grid changes are a lock the viewer can replay / Quasi sempre è un blocco che lo spettatore può ripetere
+            State locked = shadow;
+            rules.lock(locked);
+            if (locked.cells == now.cells) {
+                scratch.push_back(OP_LOCK);
+                shadow.cells = locked.cells;
+            } else {
+                uint32_t mask = 0;
+                for (int y = 0; y < HEIGHT; ++y) {
+                    if (now.cells[y] != shadow.cells[y]) mask |= 1u << y;
+                }
+                scratch.push_back(OP_ROWS);
+                putVarint(scratch, mask);
+                for (int y = 0; y < HEIGHT; ++y) {
+                    if (mask & (1u << y)) putRow(scratch, now.cells[y]);
+                }
+                shadow.cells = now.cells;
+            }
+        }
+
+        if (!now.samePiece(shadow)) {
+            bool same_shape = now.piece_type == shadow.piece_type && now.piece_rotation == shadow.piece_rotation;
+            bool same_place = now.piece_x == shadow.piece_x && now.piece_y == shadow.piece_y;
+            if (same_shape && now.piece_y == shadow.piece_y && now.piece_x == shadow.piece_x - 1) {
+                scratch.push_back(OP_PIECE_LEFT);
+            } else if (same_shape && now.piece_y == shadow.piece_y && now.piece_x == shadow.piece_x + 1) {
+                scratch.push_back(OP_PIECE_RIGHT);
+            } else if (same_shape && now.piece_x == shadow.piece_x && now.piece_y == shadow.piece_y + 1) {
+                scratch.push_back(OP_PIECE_DOWN);
+            } else if (same_place && now.piece_type == shadow.piece_type &&
+                       now.piece_rotation == (shadow.piece_rotation + 1) % 4) {
+                scratch.push_back(OP_PIECE_ROTATE);
+            } else {
+                scratch.push_back(OP_PIECE);
+                putPiece(now);
+            }
+            shadow.piece_type = now.piece_type;
+            shadow.piece_x = now.piece_x;
+            shadow.piece_y = now.piece_y;
+            shadow.piece_rotation = now.piece_rotation;
+        }
+
+        if (now.score != shadow.score || now.level != shadow.level || now.lines != shadow.lines) {
+            scratch.push_back(OP_STATS);
+            putStats(now);
+            shadow.score = now.score;
+            shadow.level = now.level;
+            shadow.lines = now.lines;
+        }
+
+        if (flags(now) != flags(shadow)) {
+            scratch.push_back(OP_FLAGS);
+            scratch.push_back(flags(now));
+            shadow.game_over = now.game_over;
+            shadow.paused = now.paused;
+        }
+    }
+};
+
+// Applies a stream to a State, one message at a time / Applica un flusso a uno State, un messaggio alla volta
+class Decoder {
+public:
+    Decoder() : has_header(false), synced(false), waiting_keyframe(false), late_join(false), failed(false),
+                offset(0), time_ms(0), seed(0) {}
+
+    // Queue received bytes / Accoda i byte ricevuti
+    void feed(const uint8_t* data, size_t size) {
+        buffer.insert(buffer.end(), data, data + size);
+    }
+
+    // Drop buffered data and skip to the next keyframe (late join) / Scarta i dati e salta al prossimo keyframe
+    void resync() {
+        buffer.clear();
+        offset = 0;
+        waiting_keyframe = true;
+        late_join = true;
+    }
+
+    // Apply one complete message; false when more data is needed or the stream is invalid
+    // Applica un messaggio completo; false se servono altri dati o il flusso non è valido
+    bool next() {
+        if (failed) return false;
+        if (!has_header) return readHeader();
+        if (waiting_keyframe && !seekKeyframe()) return false;
+
+        Reader r(buffer.data() + offset, buffer.size() - offset);
+        uint8_t op = r.u8();
+        if (r.incomplete) return false;
+
+        State s = state;
+        switch (op) {
+            case OP_TIME: {
+                uint32_t dt = r.varint();
+                if (r.incomplete) return false;
+                time_ms += dt;
+                break;
+            }
+            case OP_NEW_GAME: {
+                uint32_t value = r.varint();
+                if (r.incomplete) return false;
+                seed = value;
+                break;
+            }
+            case OP_KEYFRAME: {
+                char sync[3] = {static_cast<char>(r.u8()), static_cast<char>(r.u8()), static_cast<char>(r.u8())};
+                if (!r.incomplete && std::memcmp(sync, KEYFRAME_SYNC, 3) != 0) return fail();
+                uint32_t absolute_ms = r.varint();
+                readFlags(r, s);
+                readStats(r, s);
+                if (!readPiece(r, s)) return fail();
+                uint32_t mask = r.varint();
+                for (int y = 0; y < HEIGHT; ++y) {
+                    if (mask & (1u << y)) r.row(s.cells[y]);
+                    else s.cells[y].fill(0);
+                }
+                if (r.incomplete) return false;
+                time_ms = absolute_ms;
+                synced = true;
+                break;
+            }
+            case OP_ROWS: {
+                uint32_t mask = r.varint();
+                for (int y = 0; y < HEIGHT; ++y) {
+                    if (mask & (1u << y)) r.row(s.cells[y]);
+                }
+                break;
+            }
+            case OP_LOCK:         rules.lock(s); break;
+            case OP_PIECE:        if (!readPiece(r, s)) return fail(); break;
+            case OP_PIECE_LEFT:   s.piece_x--; break;
+            case OP_PIECE_RIGHT:  s.piece_x++; break;
+            case OP_PIECE_DOWN:   s.piece_y++; break;
+            case OP_PIECE_ROTATE: s.piece_rotation = (s.piece_rotation + 1) % 4; break;
+            case OP_STATS:        readStats(r, s); break;
+            case OP_FLAGS:        readFlags(r, s); break;
+            default:              return fail();
+        }
+        if (r.incomplete) return false;
+
+        state = s;
+        offset = r.pos - buffer.data();
+        if (offset > 4096 && offset * 2 > buffer.size()) {
+            buffer.erase(buffer.begin(), buffer.begin() + offset);
+            offset = 0;
+        }
+        return true;
+    }
+
+    const State& current() const { return state; }
+    const Rules& streamRules() const { return rules; }
+    bool headerRead() const { return has_header; }
+    bool isSynced() const { return synced; }
+    bool hasFailed() const { return failed; }
+    uint32_t timeMs() const { return time_ms; }
+    uint32_t gameSeed() const { return seed; }
+
+private:
+    std::vector<uint8_t> buffer;
+    Rules rules;
+    State state;
+    bool has_header;
+    bool synced;
+    bool waiting_keyframe;
+    bool late_join;  // Joined mid-stream: bad data means a false marker / Entrato a metà: dati errati indicano un falso marcatore
+    bool failed;
+    size_t offset;
+    uint32_t time_ms;
+    uint32_t seed;
+
+    bool fail() {
+        if (late_join) {
+            // "KFR" can occur inside other data: skip past it and look for the next keyframe
+            // "KFR" può comparire dentro altri dati: lo supera e cerca il keyframe successivo
+            offset++;
+            waiting_keyframe = true;
+            synced = false;
+            return false;
+        }
+        failed = true;
+        return false;
+    }
+
+    bool readHeader() {
+        if (buffer.size() - offset < HEADER_SIZE) return false;
+        const uint8_t* p = buffer.data() + offset;
+        if (std::memcmp(p, MAGIC, 4) != 0 || p[4] != VERSION || p[5] != WIDTH || p[6] != HEIGHT) return fail();
+        p += 7;
+        for (int t = 0; t < PIECES; ++t) {
+            for (int r = 0; r < 4; ++r, p += 2) rules.shapes[t][r] = static_cast<uint16_t>(p[0] | (p[1] << 8));
+        }
+        for (int t = 0; t < PIECES; ++t, p += 3) std::memcpy(rules.colors[t], p, 3);
+        offset += HEADER_SIZE;
+        has_header = true;
+        return true;
+    }
+
+    // Discard bytes up to the next keyframe marker / Scarta i byte fino al prossimo marcatore di keyframe
+    bool seekKeyframe() {
+        const uint8_t marker[4] = {OP_KEYFRAME, static_cast<uint8_t>(KEYFRAME_SYNC[0]),
+                                   static_cast<uint8_t>(KEYFRAME_SYNC[1]), static_cast<uint8_t>(KEYFRAME_SYNC[2])};
+        auto begin = buffer.begin() + offset;
+        auto found = std::search(begin, buffer.end(), marker, marker + 4);
+        if (found == buffer.end()) {
+            // Keep a possible partial marker / Conserva un eventuale marcatore parziale
+            size_t keep = std::min<size_t>(3, buffer.size() - offset);
+            buffer.erase(buffer.begin(), buffer.end() - keep);
+            offset = 0;
+            return false;
+        }
+        buffer.erase(buffer.begin(), found);
+        offset = 0;
+        waiting_keyframe = false;
+        return true;
+    }
+
+    static void readFlags(Reader& r, State& s) {
+        uint8_t f = r.u8();
+        s.game_over = (f & 1) != 0;
+        s.paused = (f & 2) != 0;
+    }
+
+    static void readStats(Reader& r, State& s) {
+        s.score = r.varint();
+        s.level = r.varint();
+        s.lines = r.varint();
+    }
+
+    static bool readPiece(Reader& r, State& s) {
+        uint8_t kind = r.u8();
+        int x = r.svarint();
+        int y = r.svarint();
+        if (r.incomplete) return true;  // Caller waits for more data / Il chiamante attende altri dati
+        if ((kind & 15) >= PIECES || (kind >> 4) >= 4) return false;
+        s.piece_type = kind & 15;
+        s.piece_rotation = kind >> 4;
+        s.piece_x = x;
+        s.piece_y = y;
+        return true;
+    }
+};
+
+// Non-blocking byte sink for the stream / Destinazione non bloccante per il flusso
+class Sink {
+public:
+    static constexpr size_t MAX_PENDING = 64 * 1024;  // Backlog before frames are dropped / Arretrato prima di scartare frame
+
+    Sink() : fd(-1), sent(0), broken(false), dropped_bytes(0) {}
+
+    ~Sink() {
+        close();
+    }
+
+    Sink(const Sink&) = delete;
+    Sink& operator=(const Sink&) = delete;
+
+    // Open a file or FIFO path, "-" (stdout) or "unix:/path"; false with errno set on failure
+    // Apre un percorso file o FIFO, "-" (stdout) o "unix:/path"; false con errno impostato se fallisce
+    bool open(const char* target) {
+        close();
+        if (std::strcmp(target, "-") == 0) {
+            // Own descriptor for stdout; the caller keeps its other output off stdout
+            // Descrittore proprio per stdout; il chiamante tiene il resto del suo output fuori da stdout
+            fd = ::dup(STDOUT_FILENO);
+        } else if (std::strncmp(target, "unix:", 5) == 0) {
+            sockaddr_un address;
+            std::memset(&address, 0, sizeof(address));
+            address.sun_family = AF_UNIX;
+            if (std::strlen(target + 5) >= sizeof(address.sun_path)) {
+                errno = ENAMETOOLONG;
+                return false;
+            }
+            std::strcpy(address.sun_path, target + 5);
+            fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            if (fd >= 0 && ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+                int saved = errno;
+                ::close(fd);
+                fd = -1;
+                errno = saved;
+            }
+        } else {
+            fd = ::open(target, O_WRONLY | O_CREAT | O_TRUNC, 0644);  // FIFOs wait for a reader / Le FIFO attendono un lettore
+        }
+        if (fd < 0) return false;
+
+        // A vanished viewer must not kill the game / Uno spettatore sparito non deve terminare il gioco
+        std::signal(SIGPIPE, SIG_IGN);
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+        return true;
+    }
+
+    void close() {
+        if (fd >= 0) {
+            flush();
+            ::close(fd);
+        }
+        fd = -1;
+        pending.clear();
+        sent = 0;
+        broken = false;
+    }
+
+    // Queue and send; false if the bytes were dropped because the consumer is behind
+    // Accoda e invia; false se i byte sono stati scartati perché il consumatore è in ritardo
+    bool write(const std::vector<uint8_t>& data) {
+        if (fd < 0 || broken) return false;
+        flush();
+        if (pending.size() - sent + data.size() > MAX_PENDING) {
+            dropped_bytes += data.size();
+            return false;
+        }
+        pending.insert(pending.end(), data.begin(), data.end());
+        flush();
+        return true;
+    }
+
+    bool isOpen() const { return fd >= 0; }
+    bool isBroken() const { return broken; }
+    uint64_t droppedBytes() const { return dropped_bytes; }
+
+private:
+    int fd;
+    std::vector<uint8_t> pending;  // Bytes not accepted yet / Byte non ancora accettati
+    size_t sent;                   // Prefix of `pending` already written / Parte di `pending` già scritta
+    bool broken;
+    uint64_t dropped_bytes;
+
+    void flush() {
+        while (sent < pending.size()) {
+            ssize_t n = ::write(fd, pending.data() + sent, pending.size() - sent);
+            if (n > 0) {
+                sent += static_cast<size_t>(n);
+            } else if (n < 0 && errno == EINTR) {
+                continue;
+            } else {
+                if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) broken = true;
+                break;
+            }
+        }
+        if (sent == pending.size()) {
+            pending.clear();
+            sent = 0;
+        }
+    }
+};
+
+// Encoder + sink + per-game traffic counters / Codificatore + destinazione + contatori di traffico per partita
+class Broadcaster {
+public:
+    // Traffic of one game / Traffico di una partita
+    struct GameStats {
+        uint64_t bytes;
+        uint32_t duration_ms;
+        uint32_t keyframes;
+        uint64_t dropped_bytes;
+    };
+
+    Broadcaster() : in_game(false), game_start_ms(0), game_bytes(0), game_keyframes_start(0),
+                    game_dropped_start(0), game_offset(0), total_bytes(0) {}
+
+    bool open(const char* target, const Rules& rules) {
+        if (!sink.open(target)) return false;
+        encoder.setRules(rules);
+        buffer.clear();
+        Encoder::header(rules, buffer);
+        if (sink.write(buffer)) total_bytes += buffer.size();
+        return true;
+    }
+
+    void beginGame(uint32_t seed, uint32_t now_ms) {
+        encoder.beginGame(seed);
+        in_game = true;
+        game_start_ms = now_ms;
+        game_bytes = 0;
+        game_keyframes_start = encoder.keyframeCount();
+        game_dropped_start = sink.droppedBytes();
+        game_offset = total_bytes;  // The next accepted byte belongs to this game / Il prossimo byte accettato è di questa partita
+    }
+
+    // Encode and send one frame / Codifica e invia un frame
+    void frame(const State& now, uint32_t now_ms) {
+        buffer.clear();
+        encoder.encode(now, now_ms, buffer);
+        if (buffer.empty()) return;
+        if (!sink.write(buffer)) {
+            encoder.requestKeyframe();  // Viewer state is unknown now / Lo stato dello spettatore ora è ignoto
+            return;
+        }
+        // Only bytes the sink accepted count as traffic / Conta come traffico solo ciò che la destinazione ha accettato
+        game_bytes += buffer.size();
+        total_bytes += buffer.size();
+    }
+
+    GameStats finishGame(uint32_t now_ms) {
+        GameStats stats;
+        stats.bytes = game_bytes;
+        stats.duration_ms = now_ms - game_start_ms;
+        stats.keyframes = encoder.keyframeCount() - game_keyframes_start;
+        stats.dropped_bytes = sink.droppedBytes() - game_dropped_start;
+        in_game = false;
+        return stats;
+    }
+
+    bool inGame() const { return in_game; }
+    bool isBroken() const { return sink.isBroken(); }
+    uint64_t totalBytes() const { return total_bytes; }
+    // Stream offset where the current (or last) game starts / Offset del flusso in cui inizia la partita corrente (o l'ultima)
+    uint64_t gameOffset() const { return game_offset; }
+
+private:
+    Encoder encoder;
+    Sink sink;
+    std::vector<uint8_t> buffer;  // Reused every frame / Riutilizzato a ogni frame
+    bool in_game;
+    uint32_t game_start_ms;
+    uint64_t game_bytes;
+    uint32_t game_keyframes_start;
+    uint64_t game_dropped_start;
+    uint64_t game_offset;
+    uint64_t total_bytes;
+};
+
+} // namespace spectator
+
+#endif // TETRIS_SPECTATOR_H
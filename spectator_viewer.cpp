@@ -0,0 +1,263 @@
+/*
+ * SPECTATOR VIEWER - Rebuilds and draws a game from its spectator stream
+ * VISUALIZZATORE SPETTATORI - Ricostruisce e disegna una partita dal flusso spettatori
+ *
+ * Usage / Uso:
+ *     spectator_viewer <file> [--tail]   replay a recording at its own pace, following it
+ *                                        while it grows; --tail joins at the next keyframe
+ *     spectator_viewer -                 read stdin: ./tetris --spectate - | ./spectator_viewer -
+ *     spectator_viewer unix:/path        listen on a Unix socket, one game connection at a time
+ *
+ * Everything (shapes, colors, rules) comes from the stream header, so the
+ * viewer does not depend on the game's tables.
+ * Tutto (forme, colori, regole) arriva dall'header del flusso.
+ */
+
+#include <SDL2/SDL.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "spectator.h"
+
+constexpr int CELL_SIZE = 40;  // Same as the game's BLOCK_SIZE / Come BLOCK_SIZE del gioco
+
+// Where stream bytes come from / Da dove arrivano i byte del flusso
+class StreamSource {
+public:
+    StreamSource() : fd(-1), listen_fd(-1), follow(false), ended(false) {}
+
+    ~StreamSource() {
+        if (fd >= 0 && fd != STDIN_FILENO) ::close(fd);
+        if (listen_fd >= 0) {
+            ::close(listen_fd);
+            ::unlink(socket_path.c_str());
+        }
+    }
+
+    bool open(const char* target) {
+        if (std::strcmp(target, "-") == 0) {
+            fd = STDIN_FILENO;
+        } else if (std::strncmp(target, "unix:", 5) == 0) {
+            return listenOn(target + 5);
+        } else {
+            fd = ::open(target, O_RDONLY);
+            follow = true;  // Recordings may still be growing / Le registrazioni possono ancora crescere
+        }
+        if (fd < 0) return false;
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+        return true;
+    }
+
+    // Read the header only, then continue from the current end of the file (--tail)
+    // Legge solo l'header, poi prosegue dalla fine attuale del file (--tail)
+    bool readHeaderAndSkip(spectator::Decoder& decoder) {
+        uint8_t header[spectator::HEADER_SIZE];
+        if (::pread(fd, header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) return false;
+        decoder.feed(header, sizeof(header));
+        if (!decoder.next()) return false;
+        ::lseek(fd, 0, SEEK_END);
+        decoder.resync();
+        return true;
+    }
+
+    // Non-blocking; true when a new connection replaced the stream / Non bloccante; true se una nuova connessione sostituisce il flusso
+    bool poll(spectator::Decoder& decoder) {
+        bool reconnected = false;
+        if (listen_fd >= 0 && fd < 0) {
+            fd = ::accept(listen_fd, nullptr, nullptr);
+            if (fd >= 0) {
+                ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+                std::printf("Game connected\n");
+                reconnected = true;
+            }
+        }
+        if (fd < 0 || ended) return reconnected;
+
+        uint8_t buffer[16384];
+        for (;;) {
+            ssize_t n = ::read(fd, buffer, sizeof(buffer));
+            if (n > 0) {
+                decoder.feed(buffer, static_cast<size_t>(n));
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n == 0 && !follow) {
+                // Writer gone: wait for the next game on sockets / Scrittore chiuso: sui socket attende la prossima partita
+                if (listen_fd >= 0) {
+                    ::close(fd);
+                    fd = -1;
+                    std::printf("Game disconnected\n");
+                } else {
+                    ended = true;
+                }
+            }
+            break;
+        }
+        return reconnected;
+    }
+
+    bool isFile() const {
+        return follow;
+    }
+
+private:
+    int fd;
+    int listen_fd;
+    bool follow;
+    bool ended;
+    std::string socket_path;
+
+    bool listenOn(const char* path) {
+        sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (std::strlen(path) >= sizeof(address.sun_path)) {
+            errno = ENAMETOOLONG;
+            return false;
+        }
+        std::strcpy(address.sun_path, path);
+        listen_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listen_fd < 0) return false;
+        ::unlink(path);
+        if (::bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            ::listen(listen_fd, 1) != 0) {
+            return false;
+        }
+        socket_path = path;
+        ::fcntl(listen_fd, F_SETFL, ::fcntl(listen_fd, F_GETFL) | O_NONBLOCK);
+        std::printf("Waiting for a game on %s\n", path);
+        return true;
+    }
+};
+
+static void drawCell(SDL_Renderer* renderer, int x, int y, const uint8_t* rgb) {
+    SDL_Rect block = {x * CELL_SIZE, y * CELL_SIZE, CELL_SIZE, CELL_SIZE};
+    SDL_SetRenderDrawColor(renderer, rgb[0], rgb[1], rgb[2], 255);
+    SDL_RenderFillRect(renderer, &block);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);  // Black border / Bordo nero
+    SDL_RenderDrawRect(renderer, &block);
+}
+
+static void drawState(SDL_Renderer* renderer, const spectator::Decoder& decoder) {
+    SDL_SetRenderDrawColor(renderer, 30, 30, 30, 255);
+    SDL_RenderClear(renderer);
+
+    if (decoder.isSynced()) {
+        const spectator::State& s = decoder.current();
+        const spectator::Rules& rules = decoder.streamRules();
+        for (int y = 0; y < spectator::HEIGHT; ++y) {
+            for (int x = 0; x < spectator::WIDTH; ++x) {
+                if (s.cells[y][x]) drawCell(renderer, x, y, rules.colors[s.cells[y][x] - 1]);
+            }
+        }
+        uint16_t mask = rules.shapes[s.piece_type][s.piece_rotation];
+        for (int i = 0; i < 16; ++i) {
+            int gx = s.piece_x + i % 4;
+            int gy = s.piece_y + i / 4;
+            if ((mask & (1u << i)) && gy >= 0 && gx >= 0 && gx < spectator::WIDTH) {
+                drawCell(renderer, gx, gy, rules.colors[s.piece_type]);
+            }
+        }
+    }
+    SDL_RenderPresent(renderer);
+}
+
+int main(int argc, char* argv[]) {
+    bool tail = argc > 2 && std::strcmp(argv[2], "--tail") == 0;
+    if (argc < 2 || (argc > 2 && !tail)) {
+        std::fprintf(stderr, "Usage: %s <file [--tail] | - | unix:/path>\n", argv[0]);
+        return 2;
+    }
+
+    StreamSource source;
+    if (!source.open(argv[1])) {
+        std::fprintf(stderr, "Cannot open %s: %s\n", argv[1], std::strerror(errno));
+        return 1;
+    }
+    std::unique_ptr<spectator::Decoder> decoder(new spectator::Decoder());
+    if (tail && (!source.isFile() || !source.readHeaderAndSkip(*decoder))) {
+        std::fprintf(stderr, "--tail needs a recording that already has a header\n");
+        return 1;
+    }
+
+    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+        std::fprintf(stderr, "SDL_Init failed: %s\n", SDL_GetError());
+        return 1;
+    }
+    SDL_Window* window = SDL_CreateWindow("Tetris - Spettatore", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+                                          spectator::WIDTH * CELL_SIZE, spectator::HEIGHT * CELL_SIZE, SDL_WINDOW_SHOWN);
+    SDL_Renderer* renderer = window ? SDL_CreateRenderer(window, -1, SDL_RENDERER_SOFTWARE) : nullptr;
+    if (!renderer) {
+        std::fprintf(stderr, "Window creation failed: %s\n", SDL_GetError());
+        SDL_Quit();
+        return 1;
+    }
+
+    // Recordings play back at game speed, live streams as they arrive
+    // Le registrazioni scorrono alla velocità di gioco, i flussi live appena arrivano
+    bool paced = source.isFile() && !tail;
+    bool clock_started = false;
+    Uint32 stream_offset = 0;
+    char title[128] = "";
+    bool running = true;
+    int status = 0;
+
+    while (running) {
+        SDL_Event event;
+        while (SDL_PollEvent(&event)) {
+            if (event.type == SDL_QUIT) running = false;
+        }
+
+        if (source.poll(*decoder)) {
+            decoder.reset(new spectator::Decoder());  // New connection, new stream / Nuova connessione, nuovo flusso
+            clock_started = false;
+            source.poll(*decoder);
+        }
+
+        for (;;) {
+            if (paced && decoder->isSynced()) {
+                Uint32 now = SDL_GetTicks();
+                if (!clock_started) {
+                    stream_offset = decoder->timeMs() - now;
+                    clock_started = true;
+                }
+                if (static_cast<int32_t>(decoder->timeMs() - (now + stream_offset)) > 0) break;
+            }
+            if (!decoder->next()) break;
+        }
+        if (decoder->hasFailed()) {
+            std::fprintf(stderr, "Invalid spectator stream\n");
+            status = 1;
+            break;
+        }
+
+        char next_title[128];
+        if (decoder->isSynced()) {
+            const spectator::State& s = decoder->current();
+            std::snprintf(next_title, sizeof(next_title), "Tetris - Spettatore | Score %u  Level %u  Lines %u%s",
+                          s.score, s.level, s.lines, s.game_over ? "  GAME OVER" : (s.paused ? "  PAUSA" : ""));
+        } else {
+            std::snprintf(next_title, sizeof(next_title), "Tetris - Spettatore | in attesa di un keyframe...");
+        }
+        if (std::strcmp(next_title, title) != 0) {
+            std::strcpy(title, next_title);
+            SDL_SetWindowTitle(window, title);
+        }
+
+        drawState(renderer, *decoder);
+        SDL_Delay(16);  // ~60 FPS
+    }
+
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(window);
+    SDL_Quit();
+    return status;
+}
@@ -18,17 +18,34 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
 #include <SDL2/SDL_mixer.h>
-#include <iostream>
 #include <vector>
 #include <array>
 #include <string>
 #include <cstdlib>
 #include <ctime>
 #include <memory>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include "log.h"
+#include "leaderboard.h"
+#include "audio_bus.h"
+#include "asset_pack.h"
+#ifdef TETRIS_SYNTH_SFX
+#include "sfx_synth.h"
+#endif
+#ifndef __EMSCRIPTEN__
+#include "perft.h"
+#include "spectator.h"
+#include "battle.h"
+#endif
 
 #ifdef __EMSCRIPTEN__
 #include <emscripten.h>
-#include <emscripten/bind.h>
+#include <emscripten/heap.h>
+#include <unistd.h>
 #endif
 
 // Global game control variables / Variabili globali di controllo gioco
@@ -39,6 +56,24 @@ static bool gameInitialized = false;
 static Uint32 last_pause_toggle_ms = 0;
 static const Uint32 PAUSE_TOGGLE_COOLDOWN_MS = 250;
 
+// Game clock: benchmark mode drives the loop with a virtual clock so that
+// frames can run as fast as possible with the same timings as real play
+// Orologio di gioco: la modalità benchmark usa un orologio virtuale
+static bool use_virtual_clock = false;
+static Uint32 virtual_clock_ms = 0;
+
+static Uint32 gameTicks() {
+    return use_virtual_clock ? virtual_clock_ms : SDL_GetTicks();
+}
+
+#ifdef __EMSCRIPTEN__
+// Top of the program break: static data + stack + heap high-water mark (the break never moves down)
+// Cima del program break: dati statici + stack + picco dell'heap (il break non scende mai)
+static size_t peakHeapBytes() {
+    return reinterpret_cast<uintptr_t>(sbrk(0));
+}
+#endif
+
 // Game constants / Costanti di gioco
 constexpr int WINDOW_WIDTH = 400;          // Window width in pixels / Larghezza finestra in pixel
 constexpr int GRID_WIDTH = 10;             // Number of blocks horizontally / Numero blocchi orizzontali
@@ -48,6 +83,22 @@ constexpr int GRID_OFFSET_Y = 0;           // Grid vertical offset / Offset vert
 constexpr int GRID_HEIGHT = 20;            // Number of blocks vertically / Numero blocchi verticali
 constexpr int WINDOW_HEIGHT = GRID_HEIGHT * BLOCK_SIZE; // Window height / Altezza finestra
 
+// Leaderboard log location and retention / Posizione del log classifica e conservazione
+#ifdef __EMSCRIPTEN__
+// In-memory filesystem: the web leaderboard lasts only for the page session
+// Filesystem in memoria: nel web la classifica dura solo per la sessione della pagina
+static const char* const LEADERBOARD_PATH = "/leaderboard.log";
+#else
+static const char* const LEADERBOARD_PATH = "leaderboard.log";
+#endif
+// Newest games kept by compaction, besides every top-100 record (~4.8 MB)
+// Partite più recenti conservate dalla compattazione, oltre a ogni record della top-100 (~4,8 MB)
+constexpr uint64_t LEADERBOARD_MAX_RECORDS = 100000;
+
+// Asset archive built by asset_packer; loose files are the fallback
+// Archivio risorse creato da asset_packer; i file sciolti sono il fallback
+static const char* const ASSET_PACK_PATH = "tetris.pak";
+
 // SDL Color wrapper class / Classe wrapper per colori SDL
 class Color {
 public:
@@ -99,11 +150,21 @@ private:
         #endif
     }
     
+    // Asset archive; must outlive the font and music that stream from it
+    // Archivio risorse; deve sopravvivere a font e musica che lo leggono
+    assetpack::AssetPack asset_pack;
+    
     // SDL components / Componenti SDL
     SDL_Window* window;      // Game window / Finestra di gioco
     SDL_Renderer* renderer;  // Graphics renderer / Renderer grafico
     TTF_Font* font;         // Font for text / Font per il testo
     
+#ifdef TETRIS_SYNTH_SFX
+    // Owns the PCM of synthesized effects; declared before the chunks that point into it
+    // Possiede il PCM degli effetti sintetizzati; dichiarato prima dei chunk che lo usano
+    SfxSynth sfx_synth;
+#endif
+    
     // Audio components with RAII / Componenti audio con RAII
     std::unique_ptr<Mix_Chunk, decltype(&Mix_FreeChunk)> sound_rotate;    // Rotation sound / Suono rotazione
     std::unique_ptr<Mix_Chunk, decltype(&Mix_FreeChunk)> sound_clear;     // Line clear sound / Suono eliminazione linea
@@ -111,7 +172,40 @@ private:
     std::unique_ptr<Mix_Chunk, decltype(&Mix_FreeChunk)> sound_move;      // Movement sound / Suono movimento
     std::unique_ptr<Mix_Music, decltype(&Mix_FreeMusic)> music;           // Background music / Musica di sottofondo
     
+    // Master gain applied on the audio thread / Guadagno principale applicato sul thread audio
+    AudioBus audio_bus;
+    
+    // Current game session / Sessione di gioco corrente
+    unsigned int game_seed;      // Seed of the current piece sequence / Seme della sequenza pezzi corrente
+    unsigned int games_started;  // Games started since launch / Partite iniziate dall'avvio
+    Uint32 game_start_ms;        // Game clock at start / Orologio di gioco all'avvio
+    
 public:
+    // Shape table, shared with tools that replay the movement rules
+    // Tabella forme, condivisa con gli strumenti che riproducono le regole di movimento
+    static const std::array<std::array<std::array<int, 16>, 4>, 7>& shapes() {
+        return tetromino_shapes;
+    }
+    
+    // Finished games store / Archivio partite finite
+    Leaderboard leaderboard;
+    std::string leaderboard_path;  // Empty = disabled / Vuoto = disabilitato
+    unsigned int seed_base;        // Game N uses seed_base + N / La partita N usa seed_base + N
+    
+#ifndef __EMSCRIPTEN__
+    // Spectator broadcast, null when disabled / Trasmissione spettatori, nulla se disabilitata
+    std::unique_ptr<spectator::Broadcaster> spectator_stream;
+    
+    // Opponent boards beside the main one, 0 = off; set before setup()
+    // Griglie avversarie accanto alla principale, 0 = disattivate; da impostare prima di setup()
+    int battle_boards;
+    std::unique_ptr<battle::BattleView> battle_view;
+#endif
+    
+    // Render calls issued since the last reset (read by the benchmark)
+    // Chiamate di rendering emesse dall'ultimo azzeramento (lette dal benchmark)
+    Uint32 draw_calls;
+    
     // Audio control variables / Variabili controllo audio
     int master_volume;       // Master volume (0-128) / Volume principale (0-128)
     bool audio_muted;        // Is audio muted? / È l'audio mutato?
@@ -130,6 +224,13 @@ public:
           sound_gameover(nullptr, Mix_FreeChunk),
           sound_move(nullptr, Mix_FreeChunk),
           music(nullptr, Mix_FreeMusic),
+          game_seed(0), games_started(0), game_start_ms(0),
+          leaderboard_path(LEADERBOARD_PATH),
+          seed_base(static_cast<unsigned int>(std::time(nullptr))),
+#ifndef __EMSCRIPTEN__
+          battle_boards(0),
+#endif
+          draw_calls(0),
           master_volume(38), audio_muted(false),  // Volume 30% di default (38/128 ≈ 30%)
           pause_game(false), game_over(false),
           score(0), level(1), lines_cleared_total(0) {
@@ -140,7 +241,7 @@ public:
         }
         
         // Seed random number generator / Inizializza generatore numeri casuali
-        std::srand(static_cast<unsigned int>(std::time(nullptr)));
+        std::srand(seed_base);
     }
     
     // Destructor - cleanup resources / Distruttore - pulisce risorse
@@ -152,78 +253,129 @@ public:
     bool initialize() {
         // Initialize SDL video and audio / Inizializza video e audio SDL
         if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0) {
-            std::cerr << "SDL Init Error: " << SDL_GetError() << std::endl;
+            TLOG_ERROR("sdl_init_failed", tlog::kv("error", SDL_GetError()));
             return false;
         }
         
         // Initialize SDL_ttf for text rendering / Inizializza SDL_ttf per rendering testo
         if (TTF_Init() == -1) {
-            std::cerr << "TTF Init Error: " << TTF_GetError() << std::endl;
+            TLOG_ERROR("ttf_init_failed", tlog::kv("error", TTF_GetError()));
             return false;
         }
         
         // Create game window / Crea finestra di gioco
+        int window_width = WINDOW_WIDTH;
+#ifndef __EMSCRIPTEN__
+        if (battle_boards > 0) window_width += battle::PANEL_WIDTH;  // Opponents on the right / Avversari a destra
+#endif
         window = SDL_CreateWindow("Tetris C++", 
                                 SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
-                                WINDOW_WIDTH, WINDOW_HEIGHT, SDL_WINDOW_SHOWN);
+                                window_width, WINDOW_HEIGHT, SDL_WINDOW_SHOWN);
         if (!window) {
-            std::cerr << "Window creation failed: " << SDL_GetError() << std::endl;
+            TLOG_ERROR("window_create_failed", tlog::kv("error", SDL_GetError()));
             return false;
         }
         
         // Create renderer for graphics / Crea renderer per grafica
         renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_SOFTWARE);
         if (!renderer) {
-            std::cerr << "Renderer creation failed: " << SDL_GetError() << std::endl;
+            TLOG_ERROR("renderer_create_failed", tlog::kv("error", SDL_GetError()));
             return false;
         }
         
+#ifndef __EMSCRIPTEN__
+        if (battle_boards > 0) openBattleView();
+#endif
+        
         // Initialize SDL_mixer for audio / Inizializza SDL_mixer per audio
         if (Mix_OpenAudio(44100, AUDIO_S16SYS, 2, 2048) < 0) {
-            std::cerr << "SDL_mixer could not initialize! SDL_mixer Error: " << Mix_GetError() << std::endl;
+            TLOG_ERROR("mixer_init_failed", tlog::kv("error", Mix_GetError()));
             return false;
         }
         
         return true;
     }
     
+    // Stream over an asset: from the archive without copying, else the loose file
+    // Stream su una risorsa: dall'archivio senza copie, altrimenti dal file sciolto
+    SDL_RWops* openAsset(const char* path) {
+        assetpack::AssetView view;
+        if (asset_pack.isOpen() && asset_pack.find(path, view)) {
+            return SDL_RWFromConstMem(view.data, static_cast<int>(view.size));
+        }
+        return SDL_RWFromFile(path, "rb");
+    }
+    
     // Load game assets (fonts, sounds, music) / Carica risorse di gioco (font, suoni, musica)
     bool loadAssets() {
+        if (asset_pack.open(ASSET_PACK_PATH)) {
+            TLOG_INFO("asset_pack_loaded", tlog::kv("path", ASSET_PACK_PATH));
+        } else {
+            TLOG_DEBUG("asset_pack_missing", tlog::kv("path", ASSET_PACK_PATH));
+        }
+        
         // Load font for UI text / Carica font per testo UI
-        font = TTF_OpenFont("audio/font.ttf", 20);
+        font = TTF_OpenFontRW(openAsset("audio/font.ttf"), 1, 20);
         if (!font) {
-            std::cerr << "Failed to load font: " << TTF_GetError() << std::endl;
+            TLOG_ERROR("font_load_failed", tlog::kv("error", TTF_GetError()));
             return false;
         }
         
+#ifdef TETRIS_SYNTH_SFX
+        // Synthesize sound effects; WAV files remain the fallback / Sintetizza gli effetti; i WAV restano il fallback
+        Uint64 synth_start = SDL_GetPerformanceCounter();
+        (void)synth_start;  // Read only by the log call, which may be compiled out / Letto solo dal log, che può essere rimosso
+        if (sfx_synth.generate()) {
+            sound_rotate.reset(sfx_synth.chunk(SfxSynth::SOUND_ROTATE));
+            sound_clear.reset(sfx_synth.chunk(SfxSynth::SOUND_CLEAR));
+            sound_gameover.reset(sfx_synth.chunk(SfxSynth::SOUND_GAMEOVER));
+            sound_move.reset(sfx_synth.chunk(SfxSynth::SOUND_MOVE));
+            TLOG_INFO("sfx_synthesized", tlog::kv("micros", static_cast<uint64_t>(
+                (SDL_GetPerformanceCounter() - synth_start) * 1000000 / SDL_GetPerformanceFrequency())));
+        }
+#endif
+        
         // Load sound effects / Carica effetti sonori
-        sound_rotate.reset(Mix_LoadWAV("audio/sounds/rotate.wav"));
-        sound_clear.reset(Mix_LoadWAV("audio/sounds/clear.wav"));
-        sound_gameover.reset(Mix_LoadWAV("audio/sounds/gameover.wav"));
-        sound_move.reset(Mix_LoadWAV("audio/sounds/move.wav"));
+        if (!sound_rotate) sound_rotate.reset(Mix_LoadWAV_RW(openAsset("audio/sounds/rotate.wav"), 1));
+        if (!sound_clear) sound_clear.reset(Mix_LoadWAV_RW(openAsset("audio/sounds/clear.wav"), 1));
+        if (!sound_gameover) sound_gameover.reset(Mix_LoadWAV_RW(openAsset("audio/sounds/gameover.wav"), 1));
+        if (!sound_move) sound_move.reset(Mix_LoadWAV_RW(openAsset("audio/sounds/move.wav"), 1));
         
-        // Load background music / Carica musica di sottofondo
-        music.reset(Mix_LoadMUS("audio/music/music.ogg"));
+        // Load background music (streamed from the archive) / Carica musica di sottofondo (letta dall'archivio)
+        music.reset(Mix_LoadMUS_RW(openAsset("audio/music/music.ogg"), 1));
         
         // Check if all assets loaded successfully / Verifica che tutte le risorse siano caricate
         if (!sound_rotate || !sound_clear || !sound_gameover || !sound_move || !music) {
-            std::cerr << "Failed to load sound effects or music! SDL_mixer Error: " << Mix_GetError() << std::endl;
+            TLOG_ERROR("audio_load_failed", tlog::kv("error", Mix_GetError()));
             return false;
         }
         
+        // Route volume and mute through the audio bus / Instrada volume e mute nel bus audio
+        if (!audio_bus.install()) {
+            TLOG_WARN("audio_bus_unavailable");
+        }
+        
         // Set initial volume / Imposta volume iniziale
         setMasterVolume(master_volume);
+        setAudioMuted(audio_muted);
         
         return true;
     }
     
     // Audio control functions / Funzioni controllo audio
+    // Called on every slider move: only the bus targets change, the gain ramps on the audio thread
+    // Chiamata a ogni movimento dello slider: cambiano solo gli obiettivi del bus
     void setMasterVolume(int volume) {
         master_volume = std::max(0, std::min(128, volume));  // Clamp to 0-128
         
+        if (audio_bus.isActive()) {
+            audio_bus.setVolume(master_volume);
+            return;
+        }
+        
         if (audio_muted) return;  // Don't change volume if muted / Non cambiare volume se mutato
         
-        // Set volume for music and sound effects / Imposta volume per musica ed effetti
+        // Fallback without the bus: set mixer volumes directly / Senza bus: imposta direttamente i volumi
         Mix_VolumeMusic(master_volume);
         Mix_Volume(-1, master_volume);  // All channels / Tutti i canali
     }
@@ -231,7 +383,9 @@ public:
     void setAudioMuted(bool muted) {
         audio_muted = muted;
         
-        if (audio_muted) {
+        if (audio_bus.isActive()) {
+            audio_bus.setMuted(audio_muted);
+        } else if (audio_muted) {
             // Mute all audio / Muta tutto l'audio
             Mix_VolumeMusic(0);
             Mix_Volume(-1, 0);
@@ -254,7 +408,18 @@ public:
         return audio_muted;
     }
     
+    // Audio callback profiling / Profiling della callback audio
+    const AudioBus& audioBus() const {
+        return audio_bus;
+    }
+    
     void cleanup() {
+#ifndef __EMSCRIPTEN__
+        if (spectator_stream && spectator_stream->inGame()) reportSpectatorGame(gameTicks());
+        spectator_stream.reset();
+        battle_view.reset();  // Its texture belongs to the renderer / La sua texture appartiene al renderer
+#endif
+        audio_bus.uninstall();
         sound_rotate.reset();
         sound_clear.reset();
         sound_gameover.reset();
@@ -288,6 +453,7 @@ public:
         SDL_RenderFillRect(renderer, &block);
         SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);  // Black border / Bordo nero
         SDL_RenderDrawRect(renderer, &block);
+        draw_calls += 2;
     }
     
     // Check for collisions when moving/rotating piece / Controlla collisioni durante movimento/rotazione pezzo
@@ -446,7 +612,7 @@ public:
         SDL_Color sdl_color = color.toSDL();
         SDL_Surface* surface = TTF_RenderText_Blended(font, text.c_str(), sdl_color);
         if (!surface) {
-            std::cerr << "TTF Render Error: " << TTF_GetError() << std::endl;
+            TLOG_WARN("text_render_failed", tlog::kv("error", TTF_GetError()));
             return;
         }
         
@@ -456,11 +622,137 @@ public:
         SDL_FreeSurface(surface);
         SDL_RenderCopy(renderer, texture, nullptr, &dst);
         SDL_DestroyTexture(texture);
+        draw_calls++;
+    }
+    
+    // Start a new piece sequence and game timer / Avvia una nuova sequenza pezzi e il timer di gioco
+    void beginSession() {
+        game_seed = seed_base + games_started++;
+        std::srand(game_seed);
+        game_start_ms = gameTicks();
+#ifndef __EMSCRIPTEN__
+        if (spectator_stream) {
+            if (spectator_stream->inGame()) reportSpectatorGame(game_start_ms);  // Abandoned game / Partita abbandonata
+            spectator_stream->beginGame(game_seed, game_start_ms);
+        }
+#endif
+    }
+    
+#ifndef __EMSCRIPTEN__
+    // Stream state changes to spectators; target is a path, "-" or "unix:/path"
+    // Trasmette i cambi di stato agli spettatori; destinazione: percorso, "-" o "unix:/path"
+    bool openSpectatorStream(const char* target) {
+        static_assert(spectator::WIDTH == GRID_WIDTH && spectator::HEIGHT == GRID_HEIGHT,
+                      "spectator grid size must match the game");
+        spectator::Rules rules;
+        for (int t = 0; t < 7; ++t) {
+            for (int r = 0; r < 4; ++r) {
+                for (int i = 0; i < 16; ++i) {
+                    if (tetromino_shapes[t][r][i]) rules.shapes[t][r] |= static_cast<uint16_t>(1u << i);
+                }
+            }
+            rules.colors[t][0] = tetromino_colors[t].r;
+            rules.colors[t][1] = tetromino_colors[t].g;
+            rules.colors[t][2] = tetromino_colors[t].b;
+        }
+        
+        // The stream owns stdout: log lines move to stderr / Il flusso occupa stdout: il log passa su stderr
+        if (std::strcmp(target, "-") == 0) tlog::Logger::get().setOutput(stderr);
+        
+        std::unique_ptr<spectator::Broadcaster> stream(new spectator::Broadcaster());
+        if (!stream->open(target, rules)) {
+            TLOG_ERROR("spectator_open_failed", tlog::kv("target", target), tlog::kv("error", std::strerror(errno)));
+            return false;
+        }
+        spectator_stream = std::move(stream);
+        TLOG_INFO("spectator_open", tlog::kv("target", target));
+        return true;
+    }
+    
+    // Opponent panel; the game runs without it / Pannello avversari; il gioco funziona anche senza
+    bool openBattleView() {
+        uint32_t colors[7];
+        for (int t = 0; t < 7; ++t) {
+            colors[t] = (static_cast<uint32_t>(tetromino_colors[t].r) << 16) |
+                        (static_cast<uint32_t>(tetromino_colors[t].g) << 8) | tetromino_colors[t].b;
+        }
+        std::unique_ptr<battle::BattleView> view(new battle::BattleView(tetromino_shapes, colors));
+        if (!view->create(renderer, battle_boards, seed_base, gameTicks())) {
+            TLOG_WARN("battle_view_failed", tlog::kv("error", SDL_GetError()));
+            return false;
+        }
+        battle_view = std::move(view);
+        TLOG_INFO("battle_view", tlog::kv("boards", battle_view->boardCount()));
+        return true;
+    }
+    
+    // Traffic of the game just ended, for sizing relays / Traffico della partita appena finita, per dimensionare i relay
+    void reportSpectatorGame(Uint32 now) {
+        spectator::Broadcaster::GameStats stats = spectator_stream->finishGame(now);
+        TLOG_INFO("spectator_game", tlog::kv("seed", game_seed), tlog::kv("bytes", stats.bytes),
+                  tlog::kv("bytes_per_s", static_cast<int64_t>(stats.duration_ms ? stats.bytes * 1000 / stats.duration_ms : 0)),
+                  tlog::kv("keyframes", stats.keyframes));
+        if (stats.dropped_bytes) {
+            TLOG_WARN("spectator_backlog", tlog::kv("dropped_bytes", stats.dropped_bytes));
+        }
+    }
+#endif
+    
+    // Send this frame's changes to spectators (desktop only) / Invia i cambi del frame agli spettatori (solo desktop)
+    void broadcastFrame(Uint32 now) {
+#ifndef __EMSCRIPTEN__
+        if (!spectator_stream) return;
+        
+        spectator::State state;
+        for (int y = 0; y < GRID_HEIGHT; ++y) {
+            for (int x = 0; x < GRID_WIDTH; ++x) {
+                state.cells[y][x] = static_cast<uint8_t>(grid[y][x]);
+            }
+        }
+        state.piece_type = current_piece.type;
+        state.piece_x = current_piece.x;
+        state.piece_y = current_piece.y;
+        state.piece_rotation = current_piece.rotation;
+        state.score = score;
+        state.level = level;
+        state.lines = lines_cleared_total;
+        state.game_over = game_over;
+        state.paused = pause_game;
+        spectator_stream->frame(state, now);
+        
+        if (game_over && spectator_stream->inGame()) {
+            reportSpectatorGame(now);  // Final frame is out / L'ultimo frame è stato inviato
+        }
+        if (spectator_stream->isBroken()) {
+            TLOG_WARN("spectator_disconnected", tlog::kv("bytes", spectator_stream->totalBytes()));
+            spectator_stream.reset();
+        }
+#else
+        (void)now;
+#endif
+    }
+    
+    // Store the finished game in the leaderboard / Salva la partita finita in classifica
+    void recordFinishedGame() {
+        if (!leaderboard.isOpen()) return;
+        
+        LeaderboardRecord record = {};
+        record.score = score;
+        record.level = level;
+        record.lines = lines_cleared_total;
+        record.duration_ms = gameTicks() - game_start_ms;
+        record.seed = game_seed;
+#ifndef __EMSCRIPTEN__
+        // Where the spectator recording of this game starts / Dove inizia la registrazione spettatori della partita
+        if (spectator_stream) record.replay_ref = spectator_stream->gameOffset() + 1;
+#endif
+        record.timestamp = static_cast<int64_t>(std::time(nullptr));
+        leaderboard.append(record);
     }
     
     // Reset game to initial state / Resetta gioco allo stato iniziale
     void resetGame() {
-        std::cout << "Resetting game completely..." << std::endl;
+        TLOG_INFO("game_reset", tlog::kv("score", score), tlog::kv("game_level", level), tlog::kv("lines", lines_cleared_total));
         
         // Clear the game grid / Pulisci la griglia di gioco
         for (auto& row : grid) {
@@ -475,6 +767,7 @@ public:
         pause_game = false;
         
         // Spawn first piece / Genera primo pezzo
+        beginSession();
         spawnPiece();
         
         // Restart music if needed / Riavvia musica se necessario
@@ -482,14 +775,14 @@ public:
             Mix_PlayMusic(music.get(), -1);
         }
         
-        std::cout << "Game reset complete!" << std::endl;
+        TLOG_DEBUG("game_reset_done", tlog::kv("seed", game_seed));
     }
     
     // Handle keyboard and touch input / Gestisce input da tastiera e touch
     void handleInput(const SDL_Event& event) {
         // Handle touch/mouse click for game restart / Gestisce touch/click per riavvio
         if (event.type == SDL_MOUSEBUTTONDOWN && game_over) {
-            std::cout << "Touch/Click detected during game over - Restarting game" << std::endl;
+            TLOG_INFO("restart", tlog::kv("source", "click"));
             resetGame();
             gameStartRequested = true;
             return;
@@ -498,7 +791,7 @@ public:
         if (event.type == SDL_KEYDOWN) {
             // INVIO - SEMPRE riavvia il gioco (indipendentemente dallo stato)
             if (event.key.keysym.sym == SDLK_RETURN) {
-                std::cout << "ENTER pressed - Restarting game completely" << std::endl;
+                TLOG_INFO("restart", tlog::kv("source", "enter"));
                 resetGame();
                 gameStartRequested = true;  // Assicurati che il gioco riprenda
                 return;  // Esci subito dopo il reset
@@ -507,11 +800,11 @@ public:
             if (!game_over) {  // If game is still running / Se il gioco è ancora in corso
                 if (event.key.keysym.sym == SDLK_ESCAPE && event.key.repeat == 0) {
                     // Toggle pause only on initial keydown (ignore auto-repeat)
-                    Uint32 now = SDL_GetTicks();
+                    Uint32 now = gameTicks();
                     if (now - last_pause_toggle_ms >= PAUSE_TOGGLE_COOLDOWN_MS) {
                         pause_game = !pause_game;  // Toggle pause / Commuta pausa
                         last_pause_toggle_ms = now;
-                        std::cout << "ESC pressed - Pause state: " << (pause_game ? "PAUSED" : "PLAYING") << std::endl;
+                        TLOG_DEBUG("pause_toggle", tlog::kv("paused", pause_game));
                     } else {
                         // Ignoring rapid toggle
                     }
@@ -559,6 +852,11 @@ public:
         static Uint32 last_drop = 0;
         if (last_drop == 0) last_drop = delta_time; // Initialize on first frame / Inizializza al primo frame
         
+#ifndef __EMSCRIPTEN__
+        // Opponents keep playing while this game is paused or over / Gli avversari giocano anche in pausa o a fine partita
+        if (battle_view) battle_view->update(delta_time);
+#endif
+        
         // Calculate drop delay based on level / Calcola ritardo caduta basato sul livello
         Uint32 drop_delay = 500 - (level - 1) * 40;  // Faster at higher levels / Più veloce ai livelli alti
         if (drop_delay < 100) drop_delay = 100;     // Minimum delay / Ritardo minimo
@@ -579,7 +877,8 @@ public:
                     if (!audio_muted) Mix_PlayChannel(-1, sound_gameover.get(), 0);
                     game_over = true;
                     pause_game = false;  // Assicurati che non sia in pausa quando è game over
-                    std::cout << "GAME OVER detected!" << std::endl;
+                    recordFinishedGame();
+                    TLOG_INFO("game_over", tlog::kv("score", score), tlog::kv("game_level", level), tlog::kv("lines", lines_cleared_total));
                 } else {
                     spawnPiece();           // Spawn next piece / Genera prossimo pezzo
                 }
@@ -592,10 +891,14 @@ public:
         // Clear screen with dark background / Pulisci schermo con sfondo scuro
         SDL_SetRenderDrawColor(renderer, 30, 30, 30, 255);
         SDL_RenderClear(renderer);
+        draw_calls++;
         
         // Draw game elements / Disegna elementi di gioco
         drawGrid();                    // Fixed blocks / Blocchi fissi
         drawPiece(current_piece);      // Falling piece / Pezzo in caduta
+#ifndef __EMSCRIPTEN__
+        if (battle_view) draw_calls += battle_view->draw(renderer, WINDOW_WIDTH + battle::MARGIN, battle::MARGIN);
+#endif
         
         // Draw game state messages / Disegna messaggi stato di gioco
         Color white(255, 255, 255);
@@ -632,10 +935,15 @@ public:
                 instance->handleEventsOnly();
             }
         }
+#ifdef __EMSCRIPTEN__
+        // No logging thread on the web: print queued entries once the frame is done
+        // Nessun thread di log sul web: stampa le voci in coda a frame concluso
+        tlog::Logger::get().flush();
+#endif
     }
     
     void gameLoop() {
-        Uint32 current_time = SDL_GetTicks();
+        Uint32 current_time = gameTicks();
         SDL_Event event;
         
         while (SDL_PollEvent(&event)) {
@@ -649,6 +957,7 @@ public:
         }
         
         update(current_time);
+        broadcastFrame(current_time);
         render();
     }
     
@@ -676,30 +985,58 @@ public:
             if (!audio_muted) {
                 Mix_PlayMusic(music.get(), -1);
             }
+            beginSession();
             spawnPiece();
-            std::cout << "Game started!" << std::endl;
+            TLOG_INFO("game_start", tlog::kv("seed", game_seed));
         }
     }
     
-    void run() {
+    // Initialize SDL, load assets and register the instance / Inizializza SDL, carica risorse e registra l'istanza
+    bool setup() {
         if (!initialize()) {
-            std::cerr << "Failed to initialize SDL" << std::endl;
-            return;
+            TLOG_ERROR("setup_failed", tlog::kv("stage", "initialize"));
+            return false;
         }
         
         if (!loadAssets()) {
-            std::cerr << "Failed to load assets" << std::endl;
-            return;
+            TLOG_ERROR("setup_failed", tlog::kv("stage", "assets"));
+            return false;
+        }
+        
+        // Leaderboard is optional: the game runs without it / La classifica è opzionale
+        if (!leaderboard_path.empty()) {
+            if (leaderboard.open(leaderboard_path)) {
+                leaderboard.compactIfNeeded(LEADERBOARD_MAX_RECORDS);
+            } else {
+                TLOG_WARN("leaderboard_disabled");
+            }
         }
         
+#ifdef __EMSCRIPTEN__
+        // Startup footprint, to size INITIAL_MEMORY / Memoria all'avvio, per dimensionare INITIAL_MEMORY
+        TLOG_INFO("memory", tlog::kv("peak_heap", static_cast<uint64_t>(peakHeapBytes())),
+                  tlog::kv("wasm_memory", static_cast<uint64_t>(emscripten_get_heap_size())));
+#endif
+        
         // Don't start music and spawn piece automatically / Non avviare musica e spawn automaticamente
         gameInitialized = true;
         
         instance = this;  // Set static instance / Imposta istanza statica
+        return true;
+    }
+    
+    void run() {
+        if (!setup()) {
+            return;
+        }
         
 #ifdef __EMSCRIPTEN__
         emscripten_set_main_loop(mainLoop, 60, 1);  // 60 FPS, simulate infinite loop
 #else
+        // Desktop plays from launch; the first game still needs its seed, timer and spectator session
+        // Su desktop si gioca dall'avvio; la prima partita ha comunque bisogno di seme, timer e sessione spettatori
+        beginSession();
+        
         // Desktop version with traditional loop / Versione desktop con loop tradizionale
         bool running = true;
         SDL_Event event;
@@ -716,6 +1053,7 @@ public:
             }
             
             update(current_time);
+            broadcastFrame(current_time);
             render();
             
             SDL_Delay(16); // ~60 FPS
@@ -834,6 +1172,14 @@ extern "C" {
         return 0;
     }
     
+    // Get best score ever recorded / Ottieni il miglior punteggio registrato
+    int getHighScore() {
+        if (TetrisGame::instance) {
+            return TetrisGame::instance->leaderboard.bestScore();
+        }
+        return 0;
+    }
+    
     // Check if game is running / Controlla se il gioco è in esecuzione
     bool isGameRunning() {
         if (TetrisGame::instance) {
@@ -885,16 +1231,925 @@ extern "C" {
         }
         return false;
     }
+    
+    // Audio callback profiling: calls and total time in microseconds
+    // Profiling callback audio: chiamate e tempo totale in microsecondi
+    double getAudioCallbackCount() {
+        if (TetrisGame::instance) {
+            return static_cast<double>(TetrisGame::instance->audioBus().callbackCount());
+        }
+        return 0;
+    }
+    
+    double getAudioCallbackMicros() {
+        if (TetrisGame::instance) {
+            return static_cast<double>(TetrisGame::instance->audioBus().callbackMicros());
+        }
+        return 0;
+    }
+    
+    // Memory footprint in bytes: peak heap and current WebAssembly memory size
+    // Memoria in byte: picco dell'heap e dimensione attuale della memoria WebAssembly
+    double getPeakHeapBytes() {
+        return static_cast<double>(peakHeapBytes());
+    }
+    
+    double getMemoryBytes() {
+        return static_cast<double>(emscripten_get_heap_size());
+    }
+}
+#endif
+
+#if defined(TETRIS_BENCH) && !defined(__EMSCRIPTEN__)
+/*
+ * FRAME BENCHMARK / BENCHMARK DEI FRAME
+ *
+ * Feeds a scripted input stream through the real gameLoop (handleInput ->
+ * update -> render) under the dummy SDL drivers, with a virtual 60 Hz clock
+ * and no frame delay. Reports frame time percentiles, allocations and draw
+ * calls per frame for each phase (play, pause, game over).
+ *
+ * Script format, one event per line / Formato script, un evento per riga:
+ *     <frame> <LEFT|RIGHT|UP|DOWN|ESC|ENTER|CLICK>
+ * Lines starting with '#' are comments / Le righe con '#' sono commenti.
+ */
+#include <atomic>
+#include <new>
+#include <cstring>
+
+// Allocation counter: C++ heap plus everything SDL allocates internally, on the game thread only;
+// the audio thread runs on its own clock and would make the per-frame counts nondeterministic
+// Contatore allocazioni: heap C++ più tutto ciò che SDL alloca internamente, solo nel thread di gioco;
+// il thread audio ha il suo orologio e renderebbe i conteggi per frame non deterministici
+static std::atomic<unsigned long> bench_allocations{0};
+static thread_local bool bench_game_thread = false;
+
+void* operator new(std::size_t size) {
+    if (bench_game_thread) bench_allocations++;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+// Out of line, or GCC flags the inlined free() as mismatched with operator new
+// Non inline, altrimenti GCC segnala free() inline come non corrispondente a operator new
+__attribute__((noinline)) void operator delete(void* p) noexcept { std::free(p); }
+__attribute__((noinline)) void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+static SDL_malloc_func sdl_malloc_orig;
+static SDL_calloc_func sdl_calloc_orig;
+static SDL_realloc_func sdl_realloc_orig;
+static SDL_free_func sdl_free_orig;
+
+// Blocks currently held by SDL and its libraries (soak test leak counter): every texture,
+// surface, renderer object and mixer chunk is backed by SDL_malloc, so leaking any of them shows here
+// Blocchi attualmente tenuti da SDL e dalle sue librerie (contatore perdite del soak test): texture,
+// superfici e chunk del mixer sono allocati con SDL_malloc, quindi ogni loro perdita compare qui
+static std::atomic<long> bench_sdl_live_blocks{0};
+
+static void* SDLCALL countingMalloc(size_t size) {
+    if (bench_game_thread) bench_allocations++;
+    void* p = sdl_malloc_orig(size);
+    if (p) bench_sdl_live_blocks++;
+    return p;
+}
+static void* SDLCALL countingCalloc(size_t n, size_t size) {
+    if (bench_game_thread) bench_allocations++;
+    void* p = sdl_calloc_orig(n, size);
+    if (p) bench_sdl_live_blocks++;
+    return p;
+}
+static void* SDLCALL countingRealloc(void* mem, size_t size) {
+    if (bench_game_thread) bench_allocations++;
+    void* p = sdl_realloc_orig(mem, size);
+    if (!mem && p) bench_sdl_live_blocks++;
+    return p;
+}
+static void SDLCALL countingFree(void* mem) {
+    if (mem) bench_sdl_live_blocks--;
+    sdl_free_orig(mem);
+}
+
+class FrameBenchmark {
+public:
+    enum Phase { PHASE_PLAY = 0, PHASE_PAUSE, PHASE_GAMEOVER, PHASE_COUNT };
+    
+    struct ScriptEvent {
+        Uint32 frame;
+        SDL_Keycode key;  // 0 = mouse click / click del mouse
+    };
+    
+    // Summary of one phase, also the format of the baseline file
+    // Riepilogo di una fase, anche formato del file baseline
+    struct PhaseReport {
+        unsigned long frames = 0;
+        double p50_us = 0, p95_us = 0, p99_us = 0, max_us = 0;
+        double allocs_per_frame = 0, draw_calls_per_frame = 0;
+    };
+    
+    static constexpr Uint32 FRAME_MS = 16;  // Virtual frame length (~60 FPS) / Durata frame virtuale
+    
+    FrameBenchmark(unsigned int seed, Uint32 frames) : seed(seed), frames(frames) {}
+    
+    // Load a recorded input script / Carica uno script di input registrato
+    bool loadScript(const char* path) {
+        FILE* f = std::fopen(path, "r");
+        if (!f) {
+            std::fprintf(stderr, "Cannot open bench script: %s\n", path);
+            return false;
+        }
+        char line[128];
+        char name[32];
+        unsigned int frame;
+        while (std::fgets(line, sizeof(line), f)) {
+            if (line[0] == '#' || std::sscanf(line, "%u %31s", &frame, name) != 2) continue;
+            SDL_Keycode key;
+            if (!parseKey(name, key)) {
+                std::fprintf(stderr, "Unknown bench event: %s\n", name);
+                std::fclose(f);
+                return false;
+            }
+            script.push_back({frame, key});
+        }
+        std::fclose(f);
+        std::stable_sort(script.begin(), script.end(),
+                         [](const ScriptEvent& a, const ScriptEvent& b) { return a.frame < b.frame; });
+        if (!script.empty() && script.back().frame >= frames) frames = script.back().frame + 1;
+        return true;
+    }
+    
+    // Built-in script: play with random moves, pause, top out, restart
+    // Script integrato: gioca con mosse casuali, pausa, game over, riavvio
+    void generateScript() {
+        static const SDL_Keycode moves[] = {SDLK_LEFT, SDLK_RIGHT, SDLK_UP, SDLK_DOWN, SDLK_DOWN};
+        Uint32 state = seed * 2654435761u + 1;
+        Uint32 frame = 0;
+        while (frame < frames) {
+            // ~10 s of play, then a 2 s pause / ~10 s di gioco, poi 2 s di pausa
+            for (Uint32 end = frame + 600; frame < end; frame += 4) {
+                state = state * 1664525u + 1013904223u;
+                script.push_back({frame, moves[(state >> 16) % 5]});
+            }
+            script.push_back({frame, SDLK_ESCAPE});
+            frame += 120;
+            script.push_back({frame, SDLK_ESCAPE});
+            // Hard play until the stack tops out / Solo cadute finché la pila arriva in cima
+            for (Uint32 end = frame + 1800; frame < end; frame += 2) {
+                script.push_back({frame, SDLK_DOWN});
+            }
+            // Linger on the game over screen, then restart / Resta sul game over, poi riavvia
+            frame += 180;
+            script.push_back({frame, SDLK_RETURN});
+            frame += 1;
+        }
+    }
+    
+    bool run(TetrisGame& game) {
+        game.seed_base = seed;
+        virtual_clock_ms = 1;
+        use_virtual_clock = true;
+        bench_game_thread = true;  // Count this thread's allocations / Conta le allocazioni di questo thread
+        game.startGame();
+        
+        std::vector<double> samples[PHASE_COUNT];
+        unsigned long allocs[PHASE_COUNT] = {};
+        unsigned long draws[PHASE_COUNT] = {};
+        for (auto& s : samples) s.reserve(frames);
+        
+        const double ticks_to_us = 1e6 / static_cast<double>(SDL_GetPerformanceFrequency());
+        size_t next_event = 0;
+        
+        for (Uint32 frame = 0; frame < frames; ++frame) {
+            // Queue this frame's input like the OS would / Accoda l'input del frame come farebbe il SO
+            while (next_event < script.size() && script[next_event].frame <= frame) {
+                pushEvent(script[next_event].key);
+                next_event++;
+            }
+            
+            game.draw_calls = 0;
+            unsigned long allocs_before = bench_allocations.load();
+            Uint64 start = SDL_GetPerformanceCounter();
+            game.gameLoop();
+            Uint64 end = SDL_GetPerformanceCounter();
+            unsigned long frame_allocs = bench_allocations.load() - allocs_before;
+            
+            // Attribute the frame to the state it rendered / Attribuisci il frame allo stato renderizzato
+            int phase = game.game_over ? PHASE_GAMEOVER : (game.pause_game ? PHASE_PAUSE : PHASE_PLAY);
+            samples[phase].push_back((end - start) * ticks_to_us);
+            allocs[phase] += frame_allocs;
+            draws[phase] += game.draw_calls;
+            
+            virtual_clock_ms += FRAME_MS;
+        }
+        
+        for (int p = 0; p < PHASE_COUNT; ++p) {
+            reports[p] = summarize(samples[p], allocs[p], draws[p]);
+        }
+        audio_callbacks = game.audioBus().callbackCount();
+        audio_callback_us = game.audioBus().callbackMicros();
+        audio_callback_max_us = game.audioBus().callbackMaxMicros();
+        return true;
+    }
+    
+    const PhaseReport& report(Phase phase) const {
+        return reports[phase];
+    }
+    
+    // `counters_only` leaves out the machine-dependent timings (portable baseline)
+    // `counters_only` omette i tempi, che dipendono dalla macchina (baseline portabile)
+    void printReport(FILE* out, bool counters_only = false) const {
+        std::fprintf(out, "# tetris frame benchmark\n");
+        std::fprintf(out, "seed=%u frames=%u\n", seed, frames);
+        for (int p = 0; p < PHASE_COUNT; ++p) {
+            const PhaseReport& r = reports[p];
+            if (counters_only) {
+                std::fprintf(out, "phase=%s frames=%lu allocs_per_frame=%.2f draw_calls_per_frame=%.2f\n",
+                             phaseName(p), r.frames, r.allocs_per_frame, r.draw_calls_per_frame);
+                continue;
+            }
+            std::fprintf(out, "phase=%s frames=%lu p50_us=%.1f p95_us=%.1f p99_us=%.1f max_us=%.1f "
+                              "allocs_per_frame=%.2f draw_calls_per_frame=%.2f\n",
+                         phaseName(p), r.frames, r.p50_us, r.p95_us, r.p99_us, r.max_us,
+                         r.allocs_per_frame, r.draw_calls_per_frame);
+        }
+        if (counters_only) return;
+        // Audio runs on its own clock: informational only / L'audio ha il suo orologio: solo informativo
+        std::fprintf(out, "audio callbacks=%llu avg_us=%.1f max_us=%llu\n",
+                     static_cast<unsigned long long>(audio_callbacks),
+                     audio_callbacks ? static_cast<double>(audio_callback_us) / audio_callbacks : 0.0,
+                     static_cast<unsigned long long>(audio_callback_max_us));
+    }
+    
+    // Compare against a stored report; returns false on regression
+    // Confronta con un report salvato; restituisce false in caso di regressione
+    bool compareBaseline(const char* path, double time_tolerance) const {
+        FILE* f = std::fopen(path, "r");
+        if (!f) {
+            std::fprintf(stderr, "Cannot open bench baseline: %s\n", path);
+            return false;
+        }
+        bool ok = true;
+        bool run_matches = false;
+        int phases_matched = 0;
+        char line[256];
+        char name[16];
+        while (std::fgets(line, sizeof(line), f)) {
+            // Only the same seed and length are comparable / Confrontabili solo con stesso seme e durata
+            unsigned int base_seed;
+            Uint32 base_frames;
+            if (std::sscanf(line, "seed=%u frames=%u", &base_seed, &base_frames) == 2) {
+                run_matches = base_seed == seed && base_frames == frames;
+                if (!run_matches) {
+                    std::fprintf(stderr, "Baseline run differs: seed=%u frames=%u, current seed=%u frames=%u\n",
+                                 base_seed, base_frames, seed, frames);
+                }
+                continue;
+            }
+            if (std::sscanf(line, "phase=%15s", name) != 1) continue;
+            int p = phaseIndex(name);
+            if (p < 0) continue;
+            const PhaseReport& cur = reports[p];
+            double phase_frames, allocs, draws, p95, p99;
+            if (!field(line, "frames", phase_frames) || !field(line, "allocs_per_frame", allocs) ||
+                !field(line, "draw_calls_per_frame", draws)) continue;
+            phases_matched++;
+            // Counters are deterministic for a given seed and script / I contatori sono deterministici
+            if (static_cast<unsigned long>(phase_frames) != cur.frames) {
+                std::fprintf(stderr, "MISMATCH phase=%s metric=frames baseline=%.0f current=%lu\n", name,
+                             phase_frames, cur.frames);
+                ok = false;
+            }
+            ok &= check(name, "allocs_per_frame", allocs, cur.allocs_per_frame, 0.01);
+            ok &= check(name, "draw_calls_per_frame", draws, cur.draw_calls_per_frame, 0.01);
+            // Timings are noisy and machine-dependent: compared only when the baseline has them
+            // I tempi sono rumorosi e dipendono dalla macchina: confrontati solo se presenti
+            if (field(line, "p95_us", p95)) ok &= check(name, "p95_us", p95, cur.p95_us, p95 * time_tolerance);
+            if (field(line, "p99_us", p99)) ok &= check(name, "p99_us", p99, cur.p99_us, p99 * time_tolerance);
+        }
+        std::fclose(f);
+        // An unreadable baseline must not pass the gate / Una baseline illeggibile non deve superare il controllo
+        if (!run_matches || phases_matched == 0) {
+            std::fprintf(stderr, "Invalid bench baseline: %s (%d phases, run header %s)\n", path, phases_matched,
+                         run_matches ? "ok" : "missing or different");
+            return false;
+        }
+        return ok;
+    }
+    
+    // Queue a key press (0 = mouse click) like the OS would / Accoda un tasto (0 = click) come farebbe il SO
+    static void pushEvent(SDL_Keycode key) {
+        SDL_Event event;
+        SDL_memset(&event, 0, sizeof(event));
+        if (key == 0) {
+            event.type = SDL_MOUSEBUTTONDOWN;
+        } else {
+            event.type = SDL_KEYDOWN;
+            event.key.state = SDL_PRESSED;
+            event.key.keysym.sym = key;
+        }
+        SDL_PushEvent(&event);
+    }
+    
+    // Route SDL's allocator through the counter; call before SDL_Init
+    // Instrada l'allocatore di SDL nel contatore; chiamare prima di SDL_Init
+    static void installAllocationHooks() {
+        SDL_GetMemoryFunctions(&sdl_malloc_orig, &sdl_calloc_orig, &sdl_realloc_orig, &sdl_free_orig);
+        SDL_SetMemoryFunctions(countingMalloc, countingCalloc, countingRealloc, countingFree);
+    }
+    
+private:
+    unsigned int seed;
+    Uint32 frames;
+    std::vector<ScriptEvent> script;
+    PhaseReport reports[PHASE_COUNT];
+    uint64_t audio_callbacks = 0;
+    uint64_t audio_callback_us = 0;
+    uint64_t audio_callback_max_us = 0;
+    
+    static const char* phaseName(int phase) {
+        static const char* names[PHASE_COUNT] = {"play", "pause", "gameover"};
+        return names[phase];
+    }
+    
+    static int phaseIndex(const char* name) {
+        for (int p = 0; p < PHASE_COUNT; ++p) {
+            if (std::strcmp(name, phaseName(p)) == 0) return p;
+        }
+        return -1;
+    }
+    
+    static bool parseKey(const char* name, SDL_Keycode& key) {
+        static const struct { const char* name; SDL_Keycode key; } keys[] = {
+            {"LEFT", SDLK_LEFT}, {"RIGHT", SDLK_RIGHT}, {"UP", SDLK_UP}, {"DOWN", SDLK_DOWN},
+            {"ESC", SDLK_ESCAPE}, {"ENTER", SDLK_RETURN}, {"CLICK", 0}
+        };
+        for (const auto& k : keys) {
+            if (std::strcmp(name, k.name) == 0) {
+                key = k.key;
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    // Value of ` key=` in a report line / Valore di ` key=` in una riga del report
+    static bool field(const char* line, const char* key, double& value) {
+        size_t key_len = std::strlen(key);
+        for (const char* p = std::strchr(line, ' '); p; p = std::strchr(p + 1, ' ')) {
+            if (std::strncmp(p + 1, key, key_len) == 0 && p[1 + key_len] == '=') {
+                return std::sscanf(p + 2 + key_len, "%lf", &value) == 1;
+            }
+        }
+        return false;
+    }
+    
+    static bool check(const char* phase, const char* metric, double base, double cur, double slack) {
+        if (cur <= base + slack) return true;
+        std::fprintf(stderr, "REGRESSION phase=%s metric=%s baseline=%.2f current=%.2f\n", phase, metric, base, cur);
+        return false;
+    }
+    
+    static PhaseReport summarize(std::vector<double>& s, unsigned long allocs, unsigned long draws) {
+        PhaseReport r;
+        r.frames = s.size();
+        if (s.empty()) return r;
+        std::sort(s.begin(), s.end());
+        // Nearest-rank percentile / Percentile nearest-rank
+        auto pct = [&s](double q) { return s[std::min(s.size() - 1, static_cast<size_t>(q * s.size()))]; };
+        r.p50_us = pct(0.50);
+        r.p95_us = pct(0.95);
+        r.p99_us = pct(0.99);
+        r.max_us = s.back();
+        r.allocs_per_frame = static_cast<double>(allocs) / s.size();
+        r.draw_calls_per_frame = static_cast<double>(draws) / s.size();
+        return r;
+    }
+};
+
+// Entry point for --bench / Punto di ingresso per --bench
+static int runBenchmark(int argc, char* argv[]) {
+    const char* script_path = nullptr;
+    const char* baseline_path = nullptr;
+    const char* output_path = nullptr;
+    const char* spectate_target = nullptr;
+    unsigned int seed = 12345;
+    Uint32 frames = 20000;
+    double tolerance = 0.25;
+    int battle_boards = 0;
+    bool battle_reference = false;
+    bool counters_only = false;
+    
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--script" && has_value) script_path = argv[++i];
+        else if (arg == "--baseline" && has_value) baseline_path = argv[++i];
+        else if (arg == "--output" && has_value) output_path = argv[++i];
+        else if (arg == "--seed" && has_value) seed = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--frames" && has_value) frames = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--tolerance" && has_value) tolerance = std::strtod(argv[++i], nullptr);
+        else if (arg == "--spectate" && has_value) spectate_target = argv[++i];
+        else if (arg == "--battle" && has_value) battle_boards = std::atoi(argv[++i]);
+        else if (arg == "--battle-reference") battle_reference = true;
+        else if (arg == "--counters-only") counters_only = true;
+        else {
+            std::fprintf(stderr, "Usage: %s --bench [--script file] [--frames n] [--seed n]"
+                                 " [--output file [--counters-only]] [--baseline file] [--tolerance 0.25]"
+                                 " [--spectate target] [--battle n [--battle-reference]]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (battle_reference && battle_boards <= 0) {
+        std::fprintf(stderr, "--battle-reference needs --battle n\n");
+        return 2;
+    }
+    
+    // Headless drivers, no vsync / Driver headless, nessun vsync
+    SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+    SDL_setenv("SDL_AUDIODRIVER", "dummy", 1);
+    FrameBenchmark::installAllocationHooks();
+    
+    FrameBenchmark bench(seed, frames);
+    if (script_path) {
+        if (!bench.loadScript(script_path)) return 2;
+    } else {
+        bench.generateScript();
+    }
+    
+    TetrisGame game;
+    game.leaderboard_path.clear();  // Keep benchmark games out of the leaderboard / Benchmark fuori dalla classifica
+    if (spectate_target && !game.openSpectatorStream(spectate_target)) return 2;
+    game.seed_base = seed;  // Same opponents every run / Stessi avversari a ogni esecuzione
+    game.battle_boards = battle_boards;
+    if (!game.setup()) return 2;
+    if (battle_boards > 0 && !game.battle_view) return 2;
+    if (battle_reference) game.battle_view->setPerBlock(true);
+    bench.run(game);
+    
+    bench.printReport(stdout);
+    
+    // The opponents' panel must fit the 60 FPS budget while playing, and the bots must play
+    // Il pannello avversari deve stare nel budget dei 60 FPS durante il gioco, e i bot devono giocare
+    bool battle_ok = true;
+    if (game.battle_view) {
+        const double budget_us = 1e6 / 60.0;
+        const FrameBenchmark::PhaseReport& play = bench.report(FrameBenchmark::PHASE_PLAY);
+        uint64_t pieces = game.battle_view->pieceCount();
+        battle_ok = play.p99_us <= budget_us && pieces > 0;
+        std::printf("battle boards=%d path=%s pieces=%llu top_outs=%llu uploads_per_frame=%.2f"
+                    " play_p99_us=%.1f budget_us=%.1f status=%s\n",
+                    game.battle_view->boardCount(), battle_reference ? "per-block" : "atlas",
+                    static_cast<unsigned long long>(pieces),
+                    static_cast<unsigned long long>(game.battle_view->topOutCount()),
+                    static_cast<double>(game.battle_view->uploadCount()) / frames, play.p99_us, budget_us,
+                    pieces == 0 ? "IDLE" : battle_ok ? "ok" : "OVER");
+    }
+    if (output_path) {
+        if (FILE* out = std::fopen(output_path, "w")) {
+            bench.printReport(out, counters_only);
+            std::fclose(out);
+        }
+    }
+    if (baseline_path && !bench.compareBaseline(baseline_path, tolerance)) {
+        return 1;
+    }
+    return battle_ok ? 0 : 1;
+}
+
+// Entry point for --battle-check: every bot must fill cells and top out within the time limit
+// Punto di ingresso per --battle-check: ogni bot deve riempire celle e perdere entro il limite
+static int runBattleCheck(int argc, char* argv[]) {
+    unsigned int seed = 12345;
+    int boards = battle::MAX_BOARDS;
+    double minutes = 120.0;
+    
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--boards" && has_value) boards = std::atoi(argv[++i]);
+        else if (arg == "--minutes" && has_value) minutes = std::strtod(argv[++i], nullptr);
+        else if (arg == "--seed" && has_value) seed = std::strtoul(argv[++i], nullptr, 10);
+        else {
+            std::fprintf(stderr, "Usage: %s --battle-check [--boards 100] [--minutes 120] [--seed n]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (boards < 1 || boards > battle::MAX_BOARDS || minutes <= 0) {
+        std::fprintf(stderr, "--boards must be 1..%d and --minutes positive\n", battle::MAX_BOARDS);
+        return 2;
+    }
+    
+    // Same rules and seeds as the view, simulated time, no renderer
+    // Stesse regole e semi della vista, tempo simulato, nessun renderer
+    Perft rules(TetrisGame::shapes(), std::vector<int>(1, 0), 0, 1);
+    const Uint32 limit_ms = static_cast<Uint32>(minutes * 60000.0);
+    int failed = 0;
+    Uint32 slowest_ms = 0;
+    uint64_t pieces = 0;
+    for (int i = 0; i < boards; ++i) {
+        battle::Opponent bot;
+        bot.reset(battle::botSeed(seed, i), 0);
+        int most_filled = 0;
+        Uint32 now = 0;
+        for (; now < limit_ms && !bot.isOver(); now += FrameBenchmark::FRAME_MS) {
+            if (!bot.update(rules, TetrisGame::shapes(), now)) continue;
+            int filled = 0;
+            for (int y = 0; y < GRID_HEIGHT; ++y) {
+                for (int x = 0; x < GRID_WIDTH; ++x) filled += bot.cell(x, y) != 0;
+            }
+            if (filled > most_filled) most_filled = filled;
+        }
+        pieces += bot.pieceCount();
+        if (most_filled == 0 || bot.topOutCount() == 0) {
+            std::printf("bot=%d pieces=%llu most_filled=%d topped_out=%d result=FAIL\n", i,
+                        static_cast<unsigned long long>(bot.pieceCount()), most_filled,
+                        static_cast<int>(bot.topOutCount()));
+            failed++;
+        } else if (now > slowest_ms) {
+            slowest_ms = now;
+        }
+    }
+    std::printf("battle_check boards=%d seed=%u minutes=%.0f pieces=%llu slowest_top_out_s=%u failed=%d result=%s\n",
+                boards, seed, minutes, static_cast<unsigned long long>(pieces), slowest_ms / 1000, failed,
+                failed ? "FAIL" : "PASS");
+    return failed ? 1 : 0;
+}
+
+/*
+ * SOAK TEST / TEST DI DURATA
+ *
+ * Runs the full game (input, simulation, rendering, audio) under the dummy
+ * drivers on the virtual clock with no frame delay, for many hours of game
+ * time. A scripted player cycles through play, pause, topping out, the game
+ * over screen and restarts, with occasional mid-game resets, mute toggles
+ * and music stops (so resetGame goes through Mix_PlayMusic again).
+ * Resources are sampled at regular intervals; after warm-up, a metric that
+ * keeps growing beyond its limit is reported as a leak and fails the run.
+ *
+ * Esegue il gioco completo con i driver dummy e l'orologio virtuale per
+ * molte ore di tempo di gioco, alternando gioco, pausa, game over e riavvii.
+ * Le risorse vengono campionate a intervalli regolari; dopo il riscaldamento
+ * una metrica che continua a crescere oltre il limite è una perdita.
+ */
+#include <malloc.h>
+
+class SoakTest {
+public:
+    enum Metric {
+        METRIC_RSS_KB = 0, METRIC_HEAP_KB, METRIC_SDL_BLOCKS,
+        METRIC_CHANNELS, METRIC_CHANNELS_PLAYING, METRIC_COUNT
+    };
+    
+    struct Sample {
+        double hours;                  // Simulated time / Tempo simulato
+        double values[METRIC_COUNT];
+    };
+    
+    SoakTest(unsigned int seed, double hours, int sample_count)
+        : seed(seed), hours(hours), sample_count(std::max(8, sample_count)),
+          cycle(0), cycle_frame(0), over_frames(0), restarts(0), resets(0), wall_seconds(0) {}
+    
+    void run(TetrisGame& game, FILE* progress) {
+        game.seed_base = seed;
+        virtual_clock_ms = 1;
+        use_virtual_clock = true;
+        game.startGame();
+        
+        const Uint32 frame_ms = FrameBenchmark::FRAME_MS;
+        unsigned long total_frames = static_cast<unsigned long>(hours * 3600.0 * 1000.0 / frame_ms);
+        // At most one sample per frame / Al massimo un campione per frame
+        unsigned long wanted = std::min<unsigned long>(static_cast<unsigned long>(sample_count), total_frames);
+        unsigned long next_sample = 1;
+        rng = seed * 2654435761u + 1;
+        Uint64 start = SDL_GetPerformanceCounter();
+        
+        for (unsigned long frame = 1; frame <= total_frames; ++frame) {
+            play(game);
+            game.gameLoop();
+            virtual_clock_ms += frame_ms;
+            
+            if (next_sample <= wanted && frame >= total_frames * next_sample / wanted) {
+                samples.push_back(measure(static_cast<double>(frame) * frame_ms / 3600000.0));
+                printSample(progress, samples.back());
+                std::fflush(progress);
+                while (next_sample <= wanted && frame >= total_frames * next_sample / wanted) next_sample++;
+            }
+        }
+        wall_seconds = static_cast<double>(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+    }
+    
+    // Print samples, trends and verdict; false if any metric leaks
+    // Stampa campioni, tendenze e verdetto; false se una metrica perde risorse
+    bool report(FILE* out, bool with_samples) const {
+        std::fprintf(out, "# tetris soak test\n");
+        std::fprintf(out, "seed=%u sim_hours=%.2f samples=%zu\n", seed, hours, samples.size());
+        if (with_samples) {
+            for (const Sample& s : samples) printSample(out, s);
+        }
+        std::fprintf(out, "summary restarts=%u resets=%u wall_s=%.1f speedup=%.0fx\n", restarts, resets,
+                     wall_seconds, wall_seconds > 0 ? hours * 3600.0 / wall_seconds : 0.0);
+        if (samples.size() < 2) {
+            std::fprintf(out, "result=FAIL reason=too_few_samples (run more --hours)\n");
+            return false;
+        }
+        
+        // Trend over the samples after warm-up: mean of the last quarter vs the first quarter
+        // Tendenza dopo il riscaldamento: media dell'ultimo quarto contro il primo quarto
+        size_t begin = samples.size() / 4;
+        size_t window = samples.size() - begin;
+        size_t quarter = std::max<size_t>(1, window / 4);
+        bool ok = true;
+        for (int m = 0; m < METRIC_COUNT; ++m) {
+            double first = 0, last = 0;
+            for (size_t i = 0; i < quarter; ++i) {
+                first += samples[begin + i].values[m];
+                last += samples[samples.size() - quarter + i].values[m];
+            }
+            first /= quarter;
+            last /= quarter;
+            double slope = slopePerHour(begin, m);
+            const char* status = "ok";
+            if (limits()[m] < 0) {
+                status = "info";  // Depends on wall-clock audio timing / Dipende dai tempi reali dell'audio
+            } else if (last - first > limits()[m] && slope > 0) {
+                status = "LEAK";
+                ok = false;
+            }
+            std::fprintf(out, "trend metric=%s first=%.1f last=%.1f slope_per_h=%.2f limit=%.0f status=%s\n",
+                         metricName(m), first, last, slope, limits()[m], status);
+        }
+        std::fprintf(out, "result=%s\n", ok ? "PASS" : "FAIL");
+        return ok;
+    }
+    
+private:
+    unsigned int seed;
+    double hours;
+    int sample_count;
+    std::vector<Sample> samples;
+    Uint32 rng;
+    unsigned int cycle;        // Scripted play cycles / Cicli di gioco scriptati
+    Uint32 cycle_frame;
+    Uint32 over_frames;        // Frames spent on the game over screen / Frame sulla schermata di game over
+    unsigned int restarts;
+    unsigned int resets;
+    double wall_seconds;
+    
+    static const char* metricName(int m) {
+        static const char* names[METRIC_COUNT] = {
+            "rss_kb", "heap_kb", "sdl_blocks", "channels", "channels_playing"
+        };
+        return names[m];
+    }
+    
+    // Allowed growth after warm-up, negative = not checked / Crescita ammessa dopo il riscaldamento, negativa = non controllata
+    static const double* limits() {
+        static const double table[METRIC_COUNT] = {2048, 512, 64, 0, -1};
+        return table;
+    }
+    
+    // Scripted input for one frame / Input scriptato per un frame
+    void play(TetrisGame& game) {
+        static const SDL_Keycode moves[] = {SDLK_LEFT, SDLK_RIGHT, SDLK_UP, SDLK_DOWN, SDLK_DOWN};
+        
+        if (game.game_over) {
+            if (over_frames++ == 0) {
+                if (cycle % 3 == 2) game.toggleAudioMute();
+                if (cycle % 5 == 4) Mix_HaltMusic();  // E.g. audio suspended / Es. audio sospeso
+            }
+            // Linger ~3 s, then restart with ENTER or a click / Resta ~3 s, poi riavvia con INVIO o click
+            if (over_frames > 180) {
+                FrameBenchmark::pushEvent(cycle % 2 ? SDLK_RETURN : 0);
+                nextCycle();
+                restarts++;
+            }
+            return;
+        }
+        
+        if (cycle_frame < 600) {
+            // ~10 s of random play; every 4th cycle resets mid-game / ~10 s di gioco casuale; ogni 4 cicli reset a metà partita
+            if (cycle % 4 == 3 && cycle_frame == 300) {
+                FrameBenchmark::pushEvent(SDLK_RETURN);
+                nextCycle();
+                resets++;
+                return;
+            }
+            if (cycle_frame % 4 == 0) {
+                rng = rng * 1664525u + 1013904223u;
+                FrameBenchmark::pushEvent(moves[(rng >> 16) % 5]);
+            }
+        } else if (cycle_frame == 600 || cycle_frame == 720) {
+            FrameBenchmark::pushEvent(SDLK_ESCAPE);  // 2 s pause / 2 s di pausa
+        } else if (cycle_frame > 720 && cycle_frame % 2 == 0) {
+            FrameBenchmark::pushEvent(SDLK_DOWN);  // Top out / Fino al game over
+        }
+        cycle_frame++;
+    }
+    
+    void nextCycle() {
+        cycle++;
+        cycle_frame = 0;
+        over_frames = 0;
+    }
+    
+    static Sample measure(double at_hours) {
+        Sample s;
+        s.hours = at_hours;
+        
+        long pages = 0, resident = 0;
+        if (FILE* f = std::fopen("/proc/self/statm", "r")) {
+            if (std::fscanf(f, "%ld %ld", &pages, &resident) != 2) resident = 0;
+            std::fclose(f);
+        }
+        s.values[METRIC_RSS_KB] = static_cast<double>(resident) * sysconf(_SC_PAGESIZE) / 1024.0;
+        
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+        struct mallinfo2 heap = mallinfo2();
+#else
+        struct mallinfo heap = mallinfo();
+#endif
+        s.values[METRIC_HEAP_KB] = static_cast<double>(heap.uordblks + heap.hblkhd) / 1024.0;
+        s.values[METRIC_SDL_BLOCKS] = static_cast<double>(bench_sdl_live_blocks.load());
+        s.values[METRIC_CHANNELS] = Mix_AllocateChannels(-1);
+        s.values[METRIC_CHANNELS_PLAYING] = Mix_Playing(-1);
+        return s;
+    }
+    
+    static void printSample(FILE* out, const Sample& s) {
+        std::fprintf(out, "sample t_h=%.2f", s.hours);
+        for (int m = 0; m < METRIC_COUNT; ++m) {
+            std::fprintf(out, " %s=%.0f", metricName(m), s.values[m]);
+        }
+        std::fputc('\n', out);
+    }
+    
+    // Least-squares slope from `begin` on, per simulated hour / Pendenza ai minimi quadrati da `begin`, per ora simulata
+    double slopePerHour(size_t begin, int m) const {
+        size_t n = samples.size() - begin;
+        if (n < 2) return 0;
+        double mean_t = 0, mean_v = 0;
+        for (size_t i = begin; i < samples.size(); ++i) {
+            mean_t += samples[i].hours;
+            mean_v += samples[i].values[m];
+        }
+        mean_t /= n;
+        mean_v /= n;
+        double num = 0, den = 0;
+        for (size_t i = begin; i < samples.size(); ++i) {
+            num += (samples[i].hours - mean_t) * (samples[i].values[m] - mean_v);
+            den += (samples[i].hours - mean_t) * (samples[i].hours - mean_t);
+        }
+        return den > 0 ? num / den : 0;
+    }
+};
+
+// Entry point for --soak / Punto di ingresso per --soak
+static int runSoak(int argc, char* argv[]) {
+    unsigned int seed = 12345;
+    double hours = 4.0;
+    int sample_count = 32;
+    const char* output_path = nullptr;
+    
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--hours" && has_value) hours = std::strtod(argv[++i], nullptr);
+        else if (arg == "--samples" && has_value) sample_count = std::atoi(argv[++i]);
+        else if (arg == "--seed" && has_value) seed = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--output" && has_value) output_path = argv[++i];
+        else {
+            std::fprintf(stderr, "Usage: %s --soak [--hours 4] [--samples 32] [--seed n] [--output file]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (hours <= 0) {
+        std::fprintf(stderr, "--hours must be positive\n");
+        return 2;
+    }
+    
+    SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+    SDL_setenv("SDL_AUDIODRIVER", "dummy", 1);
+    FrameBenchmark::installAllocationHooks();
+    
+    TetrisGame game;
+    game.leaderboard_path.clear();  // Keep soak games out of the leaderboard / Partite di prova fuori dalla classifica
+    if (!game.setup()) return 2;
+    
+    SoakTest soak(seed, hours, sample_count);
+    soak.run(game, stdout);
+    bool ok = soak.report(stdout, false);
+    if (output_path) {
+        if (FILE* out = std::fopen(output_path, "w")) {
+            soak.report(out, true);
+            std::fclose(out);
+        }
+    }
+    return ok ? 0 : 1;
+}
+#endif
+
+#ifndef __EMSCRIPTEN__
+/*
+ * PERFT MODE / MODALITÀ PERFT
+ *
+ * Counts reachable board states N pieces deep with the game's own movement
+ * rules, for validating faster move generators and measuring throughput.
+ * Conta gli stati raggiungibili a N pezzi di profondità con le regole del gioco.
+ *
+ * Board file: 20 lines of 10 characters, '.' empty, anything else filled
+ * File griglia: 20 righe di 10 caratteri, '.' vuoto, altro pieno
+ */
+static_assert(Perft::WIDTH == GRID_WIDTH && Perft::HEIGHT == GRID_HEIGHT, "perft grid size must match the game");
+
+static bool loadPerftBoard(const char* path, Perft::Board& board) {
+    FILE* f = std::fopen(path, "r");
+    if (!f) {
+        std::fprintf(stderr, "Cannot open board file: %s\n", path);
+        return false;
+    }
+    char line[64];
+    int y = 0;
+    while (y < GRID_HEIGHT && std::fgets(line, sizeof(line), f)) {
+        for (int x = 0; x < GRID_WIDTH && line[x] && line[x] != '\n'; ++x) {
+            if (line[x] != '.') board.rows[y] |= static_cast<uint16_t>(1u << x);
+        }
+        y++;
+    }
+    std::fclose(f);
+    board.game_over = board.rows[0] != 0;
+    return true;
+}
+
+// Entry point for --perft / Punto di ingresso per --perft
+static int runPerft(int argc, char* argv[]) {
+    int depth = argc > 2 ? std::atoi(argv[2]) : 0;
+    std::string sequence = "IJLOSTZ";
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t tt_mb = 64;
+    Perft::Board board;
+    
+    bool ok = depth > 0;
+    for (int i = 3; ok && i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--sequence" && has_value) sequence = argv[++i];
+        else if (arg == "--threads" && has_value) threads = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--tt-mb" && has_value) tt_mb = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--board" && has_value) ok = loadPerftBoard(argv[++i], board);
+        else ok = false;
+    }
+    std::vector<int> pieces;
+    if (!ok || !Perft::parseSequence(sequence, pieces)) {
+        std::fprintf(stderr, "Usage: %s --perft <depth> [--sequence IJLOSTZ] [--threads n]"
+                             " [--tt-mb n] [--board file]\n", argv[0]);
+        return 2;
+    }
+    
+    std::printf("# perft sequence=%s threads=%u tt_mb=%zu\n", sequence.c_str(), threads, tt_mb);
+    for (int d = 1; d <= depth; ++d) {
+        // Fresh tables per depth so timings are comparable / Tabelle nuove per ogni profondità
+        Perft perft(TetrisGame::shapes(), pieces, (tt_mb << 20) / threads, threads);
+        Uint64 start = SDL_GetPerformanceCounter();
+        uint64_t nodes = perft.count(board, d);
+        double seconds = static_cast<double>(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+        std::printf("depth=%d nodes=%llu time_s=%.3f nodes_per_s=%.0f\n", d,
+                    static_cast<unsigned long long>(nodes), seconds, seconds > 0 ? nodes / seconds : 0.0);
+    }
+    return 0;
 }
 #endif
 
 // Main function - entry point of the program / Funzione main - punto di ingresso del programma
 int main(int argc, char* argv[]) {
+#ifndef __EMSCRIPTEN__
+    tlog::Logger::get().startWriter();  // Log I/O off the game thread / I/O di log fuori dal thread di gioco
+#endif
+#ifndef __EMSCRIPTEN__
+    if (argc > 1 && std::string(argv[1]) == "--perft") {
+        return runPerft(argc, argv);
+    }
+#endif
+#if defined(TETRIS_BENCH) && !defined(__EMSCRIPTEN__)
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        return runBenchmark(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--soak") {
+        return runSoak(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--battle-check") {
+        return runBattleCheck(argc, argv);
+    }
+#endif
     (void)argc; // Avoid unused parameter warning / Evita warning parametro non usato
     (void)argv;
     
     // Create and run the Tetris game / Crea ed esegui il gioco Tetris
     TetrisGame game;
+#ifndef __EMSCRIPTEN__
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--spectate" && !game.openSpectatorStream(argv[i + 1])) return 1;
+        if (arg == "--battle") game.battle_boards = std::atoi(argv[i + 1]);
+    }
+#endif
     game.run();
     
     return 0;  // Exit successfully / Esci con successo
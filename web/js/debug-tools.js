@@ -26,6 +26,8 @@ const TetrisDebug = {
                 if (Module._isGameRunning) console.log('  isGameRunning:', Module._isGameRunning());
                 if (Module._isGamePaused) console.log('  isGamePaused:', Module._isGamePaused());
                 if (Module._getScore) console.log('  score:', Module._getScore());
+                if (Module._getPeakHeapBytes) console.log('  peak heap (bytes):', Module._getPeakHeapBytes());
+                if (Module._getMemoryBytes) console.log('  wasm memory (bytes):', Module._getMemoryBytes());
             } catch(e) {
                 console.log('  Error reading C++ state:', e);
             }